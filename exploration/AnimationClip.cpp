@@ -0,0 +1,503 @@
+#include "AnimationClip.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "logging/LoggingManager.h"
+namespace { auto logger = wilt::logging.createLogger("animationclip"); }
+
+namespace
+{
+  const char MAGIC[4] = { 'W', 'O', 'W', 'A' };
+  const std::uint64_t SECTION_ALIGNMENT = 16;
+
+  // the three smallest components of a unit quaternion are within this
+  const float ROTATION_RANGE = 0.70710678f;
+  const float ROTATION_STEPS = 32767.0f;
+  const float LOCATION_STEPS = 65535.0f;
+
+  static_assert(sizeof(AnimationClipHeader) == 72, "AnimationClipHeader must not contain padding");
+  static_assert(sizeof(AnimationClipTrack) == 36, "AnimationClipTrack must not contain padding");
+
+  std::uint64_t align(std::uint64_t offset)
+  {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+  }
+
+  bool validSection(std::uint64_t offset, std::uint64_t count, std::uint64_t size, std::uint64_t fileSize)
+  {
+    return offset % SECTION_ALIGNMENT == 0
+      && offset >= sizeof(AnimationClipHeader)
+      && offset <= fileSize
+      && count <= (fileSize - offset) / size;
+  }
+
+  bool validKey(AnimationTrackKind kind, std::uint32_t key, std::uint32_t staticCount, std::uint32_t sampledCount)
+  {
+    switch (kind)
+    {
+    case AnimationTrackKind::Constant: return key < staticCount;
+    case AnimationTrackKind::Linear:   return key < staticCount && staticCount - key >= 2;
+    case AnimationTrackKind::Sampled:  return key < sampledCount;
+    default:                           return false;
+    }
+  }
+
+  glm::vec3 unpackLocation(const AnimationClipTrack& track, const std::uint16_t* key)
+  {
+    return glm::vec3(
+      track.locationMin[0] + key[0] * track.locationScale[0],
+      track.locationMin[1] + key[1] * track.locationScale[1],
+      track.locationMin[2] + key[2] * track.locationScale[2]);
+  }
+
+  void packLocation(const AnimationClipTrack& track, const glm::vec3& location, std::uint16_t* key)
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      auto steps = track.locationScale[i] > 0.0f ? (location[i] - track.locationMin[i]) / track.locationScale[i] : 0.0f;
+      key[i] = (std::uint16_t)std::lround(std::clamp(steps, 0.0f, LOCATION_STEPS));
+    }
+  }
+
+  // keys hold a component in their upper 15 bits, the low bits of the first
+  // is the dropped component's sign and of the other two its index
+  glm::quat unpackRotation(const std::uint16_t* key)
+  {
+    auto dropped = ((key[1] & 1) << 1) | (key[2] & 1);
+
+    float components[4];
+    auto sum = 0.0f;
+    for (int i = 0, k = 0; i < 4; ++i)
+    {
+      if (i == dropped)
+        continue;
+
+      components[i] = (key[k++] >> 1) * (2.0f * ROTATION_RANGE / ROTATION_STEPS) - ROTATION_RANGE;
+      sum += components[i] * components[i];
+    }
+
+    components[dropped] = std::sqrt(std::max(0.0f, 1.0f - sum));
+    if (key[0] & 1)
+      components[dropped] = -components[dropped];
+
+    return glm::quat(components[3], components[0], components[1], components[2]);
+  }
+
+  void packRotation(const glm::quat& rotation, std::uint16_t* key)
+  {
+    float components[4] = { rotation.x, rotation.y, rotation.z, rotation.w };
+
+    auto dropped = 0;
+    for (int i = 1; i < 4; ++i)
+    {
+      if (std::abs(components[i]) > std::abs(components[dropped]))
+        dropped = i;
+    }
+
+    for (int i = 0, k = 0; i < 4; ++i)
+    {
+      if (i == dropped)
+        continue;
+
+      auto value = (std::clamp(components[i], -ROTATION_RANGE, ROTATION_RANGE) + ROTATION_RANGE) / (2.0f * ROTATION_RANGE);
+      key[k++] = (std::uint16_t)(std::lround(value * ROTATION_STEPS) << 1);
+    }
+
+    key[0] |= components[dropped] < 0.0f ? 1 : 0;
+    key[1] |= (dropped >> 1) & 1;
+    key[2] |= dropped & 1;
+  }
+
+  glm::quat lerpRotation(const glm::quat& a, const glm::quat& b, float t)
+  {
+    return glm::normalize(a * (1.0f - t) + b * t);
+  }
+
+  bool near(const glm::vec3& a, const glm::vec3& b, float tolerance)
+  {
+    return std::abs(a.x - b.x) <= tolerance && std::abs(a.y - b.y) <= tolerance && std::abs(a.z - b.z) <= tolerance;
+  }
+
+  bool near(const glm::quat& a, const glm::quat& b, float tolerance)
+  {
+    return std::abs(a.x - b.x) <= tolerance && std::abs(a.y - b.y) <= tolerance
+      && std::abs(a.z - b.z) <= tolerance && std::abs(a.w - b.w) <= tolerance;
+  }
+}
+
+AnimationClip::AnimationClip()
+  : _file{ }
+  , _storage{ }
+  , _header{ nullptr }
+  , _tracks{ nullptr }
+  , _staticLocations{ nullptr }
+  , _staticRotations{ nullptr }
+  , _sampledLocations{ nullptr }
+  , _sampledRotations{ nullptr }
+{ }
+
+AnimationClip::AnimationClip(AnimationClip&& s)
+  : _file{ std::move(s._file) }
+  , _storage{ std::move(s._storage) }
+  , _header{ s._header }
+  , _tracks{ s._tracks }
+  , _staticLocations{ s._staticLocations }
+  , _staticRotations{ s._staticRotations }
+  , _sampledLocations{ s._sampledLocations }
+  , _sampledRotations{ s._sampledRotations }
+{
+  s._header = nullptr;
+}
+
+AnimationClip& AnimationClip::operator= (AnimationClip&& s)
+{
+  _file = std::move(s._file);
+  _storage = std::move(s._storage);
+  _header = s._header;
+  _tracks = s._tracks;
+  _staticLocations = s._staticLocations;
+  _staticRotations = s._staticRotations;
+  _sampledLocations = s._sampledLocations;
+  _sampledRotations = s._sampledRotations;
+  s._header = nullptr;
+
+  return *this;
+}
+
+const AnimationClipHeader& AnimationClip::header() const
+{
+  return *_header;
+}
+
+std::size_t AnimationClip::frameCount() const
+{
+  return _header->frameCount;
+}
+
+std::size_t AnimationClip::jointCount() const
+{
+  return _header->jointCount;
+}
+
+std::size_t AnimationClip::bytes() const
+{
+  return _file.loaded() ? _file.size() : _storage.size();
+}
+
+void AnimationClip::decode(std::size_t frame, JointPose* poses) const
+{
+  auto t = _header->frameCount > 1 ? (float)frame / (_header->frameCount - 1) : 0.0f;
+  auto sampledLocations = _sampledLocations + frame * _header->sampledLocationCount * 3;
+  auto sampledRotations = _sampledRotations + frame * _header->sampledRotationCount * 3;
+
+  for (std::size_t i = 0; i < _header->jointCount; ++i)
+  {
+    auto& track = _tracks[i];
+    auto& pose = poses[i];
+
+    switch (track.locationKind)
+    {
+    case AnimationTrackKind::Constant:
+      pose.location = unpackLocation(track, _staticLocations + track.locationKey * 3);
+      break;
+    case AnimationTrackKind::Linear:
+      pose.location = glm::mix(
+        unpackLocation(track, _staticLocations + track.locationKey * 3),
+        unpackLocation(track, _staticLocations + track.locationKey * 3 + 3), t);
+      break;
+    case AnimationTrackKind::Sampled:
+      pose.location = unpackLocation(track, sampledLocations + track.locationKey * 3);
+      break;
+    }
+
+    switch (track.rotationKind)
+    {
+    case AnimationTrackKind::Constant:
+      pose.rotation = unpackRotation(_staticRotations + track.rotationKey * 3);
+      break;
+    case AnimationTrackKind::Linear:
+      pose.rotation = lerpRotation(
+        unpackRotation(_staticRotations + track.rotationKey * 3),
+        unpackRotation(_staticRotations + track.rotationKey * 3 + 3), t);
+      break;
+    case AnimationTrackKind::Sampled:
+      pose.rotation = unpackRotation(sampledRotations + track.rotationKey * 3);
+      break;
+    }
+  }
+}
+
+bool AnimationClip::write(const std::string& filename) const
+{
+  // written next to the old file and moved over it, like ModelFile::write
+  auto temporaryFilename = filename + ".tmp";
+  auto error = std::error_code();
+  std::ofstream file(temporaryFilename, std::ios::binary | std::ios::trunc);
+  if (!file)
+  {
+    logger.error("opening file for writing: " + temporaryFilename);
+    return false;
+  }
+
+  file.write((const char*)_header, (std::streamsize)bytes());
+  file.close();
+  if (!file)
+  {
+    logger.error("writing file: " + temporaryFilename);
+    std::filesystem::remove(temporaryFilename, error);
+    return false;
+  }
+
+  std::filesystem::rename(temporaryFilename, filename, error);
+  if (error)
+  {
+    logger.error("replacing file: " + filename);
+    std::filesystem::remove(temporaryFilename, error);
+    return false;
+  }
+
+  return true;
+}
+
+void AnimationClip::release()
+{
+  _file.release();
+  _storage.clear();
+  _header = nullptr;
+}
+
+bool AnimationClip::loaded() const
+{
+  return _header != nullptr;
+}
+
+AnimationClip AnimationClip::fromFile(const std::string& filename)
+{
+  AnimationClip clip;
+  clip._file = MappedFile::fromFile(filename);
+  if (!clip._file.loaded())
+    return clip;
+
+  if (!clip.attach(clip._file.data(), clip._file.size(), filename))
+    clip.release();
+
+  return clip;
+}
+
+AnimationClip AnimationClip::encode(const std::vector<std::vector<JointPose>>& frames)
+{
+  auto frameCount = (std::uint32_t)frames.size();
+  auto jointCount = frameCount != 0 ? (std::uint32_t)frames[0].size() : 0;
+  for (auto& frame : frames)
+  {
+    if (frame.size() != jointCount)
+    {
+      logger.error("every frame needs the same number of joints");
+      return AnimationClip{};
+    }
+  }
+
+  // pick each track's kind first, the sampled keys are laid out by frame so
+  // the number of sampled tracks has to be known before they are written
+  auto tracks = std::vector<AnimationClipTrack>(jointCount);
+  auto staticLocations = std::vector<std::uint16_t>();
+  auto staticRotations = std::vector<std::uint16_t>();
+  auto sampledLocationCount = std::uint32_t(0);
+  auto sampledRotationCount = std::uint32_t(0);
+
+  auto rotationAt = [&](std::uint32_t frame, std::uint32_t joint) { return glm::normalize(frames[frame][joint].rotation); };
+
+  for (std::uint32_t j = 0; j < jointCount; ++j)
+  {
+    auto& track = tracks[j];
+    track = AnimationClipTrack{};
+
+    auto min = frames[0][j].location;
+    auto max = frames[0][j].location;
+    for (auto& frame : frames)
+    {
+      min = glm::min(min, frame[j].location);
+      max = glm::max(max, frame[j].location);
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+      track.locationMin[i] = min[i];
+      track.locationScale[i] = (max[i] - min[i]) / LOCATION_STEPS;
+    }
+
+    auto first = frames.front()[j].location;
+    auto last = frames.back()[j].location;
+    auto constant = true;
+    auto linear = true;
+    for (std::uint32_t f = 0; f < frameCount; ++f)
+    {
+      auto t = frameCount > 1 ? (float)f / (frameCount - 1) : 0.0f;
+      constant = constant && near(frames[f][j].location, first, LOCATION_TOLERANCE);
+      linear = linear && near(frames[f][j].location, glm::mix(first, last, t), LOCATION_TOLERANCE);
+    }
+
+    track.locationKind = constant ? AnimationTrackKind::Constant : linear ? AnimationTrackKind::Linear : AnimationTrackKind::Sampled;
+    if (track.locationKind == AnimationTrackKind::Sampled)
+    {
+      track.locationKey = sampledLocationCount++;
+    }
+    else
+    {
+      track.locationKey = (std::uint32_t)(staticLocations.size() / 3);
+      staticLocations.resize(staticLocations.size() + 3);
+      packLocation(track, first, &staticLocations[staticLocations.size() - 3]);
+      if (track.locationKind == AnimationTrackKind::Linear)
+      {
+        staticLocations.resize(staticLocations.size() + 3);
+        packLocation(track, last, &staticLocations[staticLocations.size() - 3]);
+      }
+    }
+
+    auto firstRotation = rotationAt(0, j);
+    auto lastRotation = rotationAt(frameCount - 1, j);
+    constant = true;
+    linear = true;
+    for (std::uint32_t f = 0; f < frameCount; ++f)
+    {
+      auto t = frameCount > 1 ? (float)f / (frameCount - 1) : 0.0f;
+      constant = constant && near(rotationAt(f, j), firstRotation, ROTATION_TOLERANCE);
+      linear = linear && near(rotationAt(f, j), lerpRotation(firstRotation, lastRotation, t), ROTATION_TOLERANCE);
+    }
+
+    track.rotationKind = constant ? AnimationTrackKind::Constant : linear ? AnimationTrackKind::Linear : AnimationTrackKind::Sampled;
+    if (track.rotationKind == AnimationTrackKind::Sampled)
+    {
+      track.rotationKey = sampledRotationCount++;
+    }
+    else
+    {
+      track.rotationKey = (std::uint32_t)(staticRotations.size() / 3);
+      staticRotations.resize(staticRotations.size() + 3);
+      packRotation(firstRotation, &staticRotations[staticRotations.size() - 3]);
+      if (track.rotationKind == AnimationTrackKind::Linear)
+      {
+        staticRotations.resize(staticRotations.size() + 3);
+        packRotation(lastRotation, &staticRotations[staticRotations.size() - 3]);
+      }
+    }
+  }
+
+  AnimationClipHeader header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.frameCount = frameCount;
+  header.jointCount = jointCount;
+  header.staticLocationCount = (std::uint32_t)(staticLocations.size() / 3);
+  header.staticRotationCount = (std::uint32_t)(staticRotations.size() / 3);
+  header.sampledLocationCount = sampledLocationCount;
+  header.sampledRotationCount = sampledRotationCount;
+  header.trackOffset = align(sizeof(AnimationClipHeader));
+  header.staticLocationOffset = align(header.trackOffset + tracks.size() * sizeof(AnimationClipTrack));
+  header.staticRotationOffset = align(header.staticLocationOffset + staticLocations.size() * sizeof(std::uint16_t));
+  header.sampledLocationOffset = align(header.staticRotationOffset + staticRotations.size() * sizeof(std::uint16_t));
+  header.sampledRotationOffset = align(header.sampledLocationOffset + (std::uint64_t)frameCount * sampledLocationCount * 3 * sizeof(std::uint16_t));
+  auto size = header.sampledRotationOffset + (std::uint64_t)frameCount * sampledRotationCount * 3 * sizeof(std::uint16_t);
+
+  AnimationClip clip;
+  clip._storage.resize((std::size_t)size);
+  auto data = clip._storage.data();
+  std::memcpy(data, &header, sizeof(header));
+  std::memcpy(data + header.trackOffset, tracks.data(), tracks.size() * sizeof(AnimationClipTrack));
+  std::memcpy(data + header.staticLocationOffset, staticLocations.data(), staticLocations.size() * sizeof(std::uint16_t));
+  std::memcpy(data + header.staticRotationOffset, staticRotations.data(), staticRotations.size() * sizeof(std::uint16_t));
+
+  auto sampledLocations = (std::uint16_t*)(data + header.sampledLocationOffset);
+  auto sampledRotations = (std::uint16_t*)(data + header.sampledRotationOffset);
+  for (std::uint32_t f = 0; f < frameCount; ++f)
+  {
+    for (std::uint32_t j = 0; j < jointCount; ++j)
+    {
+      auto& track = tracks[j];
+      if (track.locationKind == AnimationTrackKind::Sampled)
+        packLocation(track, frames[f][j].location, sampledLocations + ((std::size_t)f * sampledLocationCount + track.locationKey) * 3);
+      if (track.rotationKind == AnimationTrackKind::Sampled)
+        packRotation(rotationAt(f, j), sampledRotations + ((std::size_t)f * sampledRotationCount + track.rotationKey) * 3);
+    }
+  }
+
+  clip.attach(data, clip._storage.size(), "<memory>");
+  return clip;
+}
+
+bool AnimationClip::readFrames(TextReader& file, std::vector<std::vector<JointPose>>& frames)
+{
+  unsigned int frameCount;
+  unsigned int boneCount;
+  file >> frameCount >> boneCount;
+  if (file.fail())
+    return false;
+
+  frames.assign(frameCount, std::vector<JointPose>(boneCount));
+  for (auto& frame : frames)
+  {
+    for (auto& pose : frame)
+    {
+      file >> pose.location[0];
+      file >> pose.location[1];
+      file >> pose.location[2];
+
+      file >> pose.rotation[3]; // w
+      file >> pose.rotation[0]; // x
+      file >> pose.rotation[1]; // y
+      file >> pose.rotation[2]; // z
+    }
+  }
+
+  return !file.fail();
+}
+
+bool AnimationClip::attach(const char* data, std::size_t size, const std::string& source)
+{
+  auto header = (const AnimationClipHeader*)data;
+  if (size < sizeof(AnimationClipHeader) || std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0)
+  {
+    logger.error("not an animation clip: " + source);
+    return false;
+  }
+
+  if (header->version != VERSION)
+  {
+    logger.error("unsupported animation clip version: " + source);
+    return false;
+  }
+
+  auto fileSize = (std::uint64_t)size;
+  if (!validSection(header->trackOffset, header->jointCount, sizeof(AnimationClipTrack), fileSize) ||
+      !validSection(header->staticLocationOffset, (std::uint64_t)header->staticLocationCount * 3, sizeof(std::uint16_t), fileSize) ||
+      !validSection(header->staticRotationOffset, (std::uint64_t)header->staticRotationCount * 3, sizeof(std::uint16_t), fileSize) ||
+      !validSection(header->sampledLocationOffset, (std::uint64_t)header->frameCount * header->sampledLocationCount * 3, sizeof(std::uint16_t), fileSize) ||
+      !validSection(header->sampledRotationOffset, (std::uint64_t)header->frameCount * header->sampledRotationCount * 3, sizeof(std::uint16_t), fileSize))
+  {
+    logger.error("truncated animation clip: " + source);
+    return false;
+  }
+
+  // checked once here so decode() can follow the keys without checking
+  auto tracks = (const AnimationClipTrack*)(data + header->trackOffset);
+  for (std::uint32_t i = 0; i < header->jointCount; ++i)
+  {
+    if (!validKey(tracks[i].locationKind, tracks[i].locationKey, header->staticLocationCount, header->sampledLocationCount) ||
+        !validKey(tracks[i].rotationKind, tracks[i].rotationKey, header->staticRotationCount, header->sampledRotationCount))
+    {
+      logger.error("corrupt animation clip track: " + source);
+      return false;
+    }
+  }
+
+  _header = header;
+  _tracks = tracks;
+  _staticLocations = (const std::uint16_t*)(data + header->staticLocationOffset);
+  _staticRotations = (const std::uint16_t*)(data + header->staticRotationOffset);
+  _sampledLocations = (const std::uint16_t*)(data + header->sampledLocationOffset);
+  _sampledRotations = (const std::uint16_t*)(data + header->sampledRotationOffset);
+  return true;
+}
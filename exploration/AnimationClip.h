@@ -0,0 +1,123 @@
+#ifndef WILT_ANIMATIONCLIP_H
+#define WILT_ANIMATIONCLIP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "graphics/jointPose.h"
+#include "utilities/mappedFile.h"
+#include "utilities/textReader.h"
+
+// The binary animation clip (*_animation.bin) as produced by convert_animation
+// from the text files blender_export_animation.py writes. Everything is stored
+// in host byte order and each section starts on a 16-byte boundary.
+//
+//   AnimationClipHeader
+//   AnimationClipTrack  tracks[jointCount]
+//   uint16              staticLocations[staticLocationCount][3]
+//   uint16              staticRotations[staticRotationCount][3]
+//   uint16              sampledLocations[frameCount][sampledLocationCount][3]
+//   uint16              sampledRotations[frameCount][sampledRotationCount][3]
+//
+// Each joint has a location and a rotation track. A track that doesn't move
+// keeps one static key, one that moves in a straight line from the first frame
+// to the last keeps two, and the rest keep a key in every frame. The sampled
+// keys are stored a frame at a time, so decoding a frame reads two contiguous
+// runs.
+//
+// Locations are quantized to 16 bits over the range the track covers.
+// Rotations are stored "smallest three": the largest component is dropped and
+// the other three are quantized to 15 bits, with the spare bits holding the
+// dropped component's index and sign. Keeping the sign means clips decode to
+// the same quaternions that were exported, not just the same rotations.
+
+enum class AnimationTrackKind : std::uint8_t
+{
+  Constant, // one static key
+  Linear,   // two static keys, the first and last frame
+  Sampled,  // a sampled key every frame
+};
+
+struct AnimationClipHeader
+{
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t frameCount;
+  std::uint32_t jointCount;
+  std::uint32_t staticLocationCount;  // keys
+  std::uint32_t staticRotationCount;  // keys
+  std::uint32_t sampledLocationCount; // keys per frame
+  std::uint32_t sampledRotationCount; // keys per frame
+  std::uint64_t trackOffset;
+  std::uint64_t staticLocationOffset;
+  std::uint64_t staticRotationOffset;
+  std::uint64_t sampledLocationOffset;
+  std::uint64_t sampledRotationOffset;
+};
+
+struct AnimationClipTrack
+{
+  AnimationTrackKind locationKind;
+  AnimationTrackKind rotationKind;
+  std::uint16_t reserved;
+  std::uint32_t locationKey; // first static key, or the key within each frame
+  std::uint32_t rotationKey;
+  float locationMin[3];
+  float locationScale[3];    // location = min + key * scale
+};
+
+class AnimationClip
+{
+private:
+  MappedFile _file;
+  std::vector<char> _storage; // backs clips encoded in memory
+  const AnimationClipHeader* _header;
+  const AnimationClipTrack* _tracks;
+  const std::uint16_t* _staticLocations;
+  const std::uint16_t* _staticRotations;
+  const std::uint16_t* _sampledLocations;
+  const std::uint16_t* _sampledRotations;
+
+public:
+  AnimationClip();
+  AnimationClip(const AnimationClip& s) = delete;
+  AnimationClip(AnimationClip&& s);
+
+  AnimationClip& operator= (const AnimationClip& s) = delete;
+  AnimationClip& operator= (AnimationClip&& s);
+
+public:
+  const AnimationClipHeader& header() const;
+  std::size_t frameCount() const;
+  std::size_t jointCount() const;
+  std::size_t bytes() const;
+
+  // writes the pose of every joint at the frame
+  void decode(std::size_t frame, JointPose* poses) const;
+
+  bool write(const std::string& filename) const;
+  void release();
+  bool loaded() const;
+
+public:
+  static AnimationClip fromFile(const std::string& filename);
+  static AnimationClip encode(const std::vector<std::vector<JointPose>>& frames);
+
+  // reads the text export, frameCount boneCount and then a location and
+  // quaternion (w x y z) for each bone of each frame
+  static bool readFrames(TextReader& file, std::vector<std::vector<JointPose>>& frames);
+
+public:
+  static const std::uint32_t VERSION = 1;
+
+  // how far elided tracks may stray from the exported keys
+  static constexpr float LOCATION_TOLERANCE = 1e-4f;
+  static constexpr float ROTATION_TOLERANCE = 1e-4f;
+
+private:
+  bool attach(const char* data, std::size_t size, const std::string& source);
+
+}; // class AnimationClip
+
+#endif // !WILT_ANIMATIONCLIP_H
@@ -1,7 +1,7 @@
 #ifndef WILT_DECORATIONMODEL_H
 #define WILT_DECORATIONMODEL_H
 
-#include <fstream>
+#include <string>
 
 #include "Model.h"
 #include "entities/DecorationEntity.h"
@@ -22,7 +22,7 @@ public:
     return new DecorationEntity(this, info);
   }
 
-  void read(std::ifstream& file)
+  void read(TextReader& file)
   {
     // get rotations
     transform = glm::scale(glm::mat4(), { 1.0f, 1.0f, 1.0f });
@@ -54,6 +54,37 @@ public:
       break;
     }
   }
+
+  bool map(const std::string& filename)
+  {
+    if (!Model::map(filename))
+      return false;
+
+    // the distances are stored as the binary model's parameters, in the same
+    // order as the text format
+    auto parameters = binary.parameters();
+    if (parameters.size() == 6)
+    {
+      farHideDistance = parameters[0];
+      farDrawDistance = parameters[1];
+      farDrawRate = parameters[2];
+      nearHideDistance = parameters[3];
+      nearDrawDistance = parameters[4];
+      nearDrawRate = parameters[5];
+    }
+
+    return true;
+  }
+
+  bool write(const std::string& filename) const
+  {
+    float parameters[] = {
+      farHideDistance, farDrawDistance, farDrawRate,
+      nearHideDistance, nearDrawDistance, nearDrawRate
+    };
+
+    return Model::write(filename, { parameters, 6 });
+  }
 };
 
 #endif // !WILT_DECORATIONMODEL_H
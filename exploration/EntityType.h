@@ -3,7 +3,11 @@
 
 #include <filesystem>
 #include <iostream>
-#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "utilities/textReader.h"
 
 class Model;
 class Entity;
@@ -15,7 +19,13 @@ public:
   virtual void read() = 0;
   virtual void load() = 0;
   virtual void unload() = 0;
-  virtual void reload() = 0;
+
+  // hot reloading is split in two: prepareReload() parses the file into a
+  // separate model and may be called from any thread, finishReload() swaps it
+  // in and must be called on the GL thread between frames
+  virtual bool dependsOn(const std::filesystem::path& path) const = 0;
+  virtual void prepareReload() = 0;
+  virtual void finishReload() = 0;
 
   virtual Model* getModel() const = 0;
   virtual Entity* spawn(const EntitySpawnInfo& info) = 0;
@@ -26,9 +36,11 @@ class EntityType : public IEntityType
 {
 private:
   std::string filename;
-  std::filesystem::file_time_type fileLoadTime;
   TModel* model;
 
+  std::mutex stagedMutex;
+  std::unique_ptr<TModel> staged;
+
 public:
   EntityType(std::string filename)
     : filename{ filename }
@@ -38,15 +50,7 @@ public:
 public:
   void read() override
   {
-    fileLoadTime = std::filesystem::last_write_time(filename);
-    std::ifstream file(filename);
-    if (!file)
-      return;
-
-    std::string type;
-    file >> type;
-
-    model->read(file);
+    read(*model);
   }
 
   void load() override
@@ -59,17 +63,41 @@ public:
     model->unload();
   }
 
-  void reload() override
+  bool dependsOn(const std::filesystem::path& path) const override
+  {
+    auto textPath = std::filesystem::path(filename).lexically_normal();
+    auto binaryPath = std::filesystem::path(textPath).replace_extension(".bin");
+    auto changedPath = path.lexically_normal();
+
+    return changedPath == textPath || changedPath == binaryPath;
+  }
+
+  void prepareReload() override
+  {
+    std::cout << "reloading: " << filename << std::endl;
+
+    auto next = std::make_unique<TModel>();
+    read(*next);
+
+    std::lock_guard<std::mutex> lock(stagedMutex);
+    staged = std::move(next);
+  }
+
+  void finishReload() override
   {
-    auto time = std::filesystem::last_write_time(filename);
-    if (time == fileLoadTime)
+    std::unique_ptr<TModel> next;
+    {
+      std::lock_guard<std::mutex> lock(stagedMutex);
+      next = std::move(staged);
+    }
+    if (!next)
       return;
 
-    std::cout << "reloading: " << filename;
-    unload();
-    read();
-    load();
-    fileLoadTime = time;
+    // entities keep pointers to the model, so the new data is moved into it
+    // rather than replacing it; the GL objects carry over and are refilled
+    next->takeBuffers(*model);
+    *model = std::move(*next);
+    model->reload();
   }
 
   Model* getModel() const override
@@ -81,6 +109,29 @@ public:
   {
     return new TEntity(model, info);
   }
+
+private:
+  void read(TModel& target)
+  {
+    // prefer the converted binary model unless the text file has been edited
+    // since it was converted
+    auto fileError = std::error_code();
+    auto fileTime = std::filesystem::last_write_time(filename, fileError);
+    auto binaryFilename = std::filesystem::path(filename).replace_extension(".bin");
+    auto binaryError = std::error_code();
+    auto binaryTime = std::filesystem::last_write_time(binaryFilename, binaryError);
+    if (!fileError && !binaryError && binaryTime >= fileTime && target.map(binaryFilename.string()))
+      return;
+
+    auto file = TextReader::fromFile(filename);
+    if (!file)
+      return;
+
+    std::string type;
+    file >> type;
+
+    target.read(file);
+  }
 };
 
 #include "Model.h"
@@ -13,6 +13,8 @@ class ICamera;
 class Entity;
 class IEntityType;
 class LineProgram;
+class ModelInstances;
+class EntityTree;
 
 class GameState
 {
@@ -25,14 +27,18 @@ public:
   std::map<std::string, IEntityType*>& types;
   std::vector<Entity*>& entities;
   LineProgram& lineProgram;
+  ModelInstances& instances;
+  EntityTree& entityTree; // for finding entities by area or along a ray
 
   std::vector<Entity*> addList;
   std::vector<Entity*> removeList;
 };
 
 #include "EntityType.h"
+#include "ModelInstances.h"
 #include "cameras/ICamera.h"
 #include "entities/Entity.h"
+#include "entities/EntityTree.h"
 #include "graphics/programs/LineProgram.h"
 
 #endif // !WILT_GAMESTATE_H
@@ -1,6 +1,6 @@
 #include "Model.h"
 
-#include <fstream>
+#include <algorithm>
 
 #include <glad/glad.h>
 #include <cimg/cimg.h>
@@ -8,65 +8,162 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/euler_angles.hpp>
 
+namespace
+{
+  // small meshes get 16-bit indexes, which halves the index buffers
+  GLenum chooseIndexType(ArrayView<const unsigned int> faceIndexes, ArrayView<const unsigned int> lineIndexes)
+  {
+    unsigned int largest = 0;
+    for (auto index : faceIndexes)
+      largest = std::max(largest, index);
+    for (auto index : lineIndexes)
+      largest = std::max(largest, index);
+
+    return largest <= 0xFFFF ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+  }
+
+  ArrayView<const unsigned char> packIndexes(ArrayView<const unsigned int> indexes, GLenum type, std::vector<unsigned short>& storage)
+  {
+    if (type == GL_UNSIGNED_INT)
+      return { (const unsigned char*)indexes.data(), indexes.bytes() };
+
+    storage.assign(indexes.begin(), indexes.end());
+    return { (const unsigned char*)storage.data(), storage.size() * sizeof(unsigned short) };
+  }
+
+  // boundingA/B are only in some formats (and describe the decoration
+  // growth), so culling uses the box around the vertices instead; skinned
+  // models get room for their joints to move
+  Bounds vertexBounds(ArrayView<const float> vertices, bool skinned)
+  {
+    if (vertices.size() < Model::DATA_COUNT_PER_VERTEX)
+      return Bounds{ glm::vec3(0.0f), glm::vec3(0.0f) };
+
+    auto bounds = Bounds{ glm::vec3(vertices[0], vertices[1], vertices[2]), glm::vec3(vertices[0], vertices[1], vertices[2]) };
+    for (std::size_t i = 0; i < vertices.size(); i += Model::DATA_COUNT_PER_VERTEX)
+    {
+      auto position = glm::vec3(vertices[i + 0], vertices[i + 1], vertices[i + 2]);
+      bounds.min = glm::min(bounds.min, position);
+      bounds.max = glm::max(bounds.max, position);
+    }
+
+    if (skinned)
+      bounds = bounds.grown(bounds.extents());
+
+    return bounds;
+  }
+}
+
+VertexLayout Model::preferredLayout = VertexLayout::Quantized;
+
 void Model::load()
 {
+  auto& buffers = ModelBuffers::shared;
+
   // load vertices
-  glGenVertexArrays(1, &vertexDataVAO);
-  glGenBuffers(1, &vertexDataVBO);
-  glBindVertexArray(vertexDataVAO);
-  glBindBuffer(GL_ARRAY_BUFFER, vertexDataVBO);
-  glBufferData(GL_ARRAY_BUFFER, vertexData.size() * sizeof(float), vertexData.data(), GL_STATIC_DRAW);
-  glEnableVertexAttribArray(0);
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)0);
-  glEnableVertexAttribArray(1);
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(3 * sizeof(float)));
-  glEnableVertexAttribArray(2);
-  glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(6 * sizeof(float)));
-  glEnableVertexAttribArray(3);
-  glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, 10 * sizeof(float), (void*)(9 * sizeof(float)));
-
-  // load faces (again)
-  glGenBuffers(1, &faceIndexesID);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, faceIndexesID);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, faceIndexes.size() * sizeof(unsigned int), faceIndexes.data(), GL_STATIC_DRAW);
-
-  // load lines
-  glGenBuffers(1, &lineIndexesID);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lineIndexesID);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, lineIndexes.size() * sizeof(unsigned int), lineIndexes.data(), GL_STATIC_DRAW);
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  std::vector<unsigned char> packedStorage;
+  vertexLayout = chooseVertexLayout(vertices(), preferredLayout);
+  vertexRange = buffers.addVertices(vertexLayout, packVertices(vertices(), vertexLayout, packedStorage));
+
+  // load faces and lines
+  std::vector<unsigned short> shortStorage;
+  indexType = chooseIndexType(faces(), lines());
+  faceRange = buffers.addIndexes(packIndexes(faces(), indexType, shortStorage));
+  lineRange = buffers.addIndexes(packIndexes(lines(), indexType, shortStorage));
+
+  bounds = vertexBounds(vertices(), !joints.empty());
+  skeleton = Skeleton::bake(joints);
+  loaded = true;
+}
+
+void Model::reload()
+{
+  if (!loaded)
+  {
+    load();
+    return;
+  }
+
+  auto& buffers = ModelBuffers::shared;
+
+  // the ranges are rewritten in place when the data is the same size, if the
+  // new data packs differently it moves to the other layout's buffer
+  std::vector<unsigned char> packedStorage;
+  auto layout = chooseVertexLayout(vertices(), preferredLayout);
+  auto packedVertexData = packVertices(vertices(), layout, packedStorage);
+  if (layout == vertexLayout)
+  {
+    buffers.updateVertices(vertexLayout, vertexRange, packedVertexData);
+  }
+  else
+  {
+    buffers.removeVertices(vertexLayout, vertexRange);
+    vertexLayout = layout;
+    vertexRange = buffers.addVertices(vertexLayout, packedVertexData);
+  }
+
+  std::vector<unsigned short> shortStorage;
+  indexType = chooseIndexType(faces(), lines());
+  buffers.updateIndexes(faceRange, packIndexes(faces(), indexType, shortStorage));
+  buffers.updateIndexes(lineRange, packIndexes(lines(), indexType, shortStorage));
+
+  bounds = vertexBounds(vertices(), !joints.empty());
+  skeleton = Skeleton::bake(joints);
 }
 
 void Model::unload()
 {
-  glDeleteBuffers(1, &lineIndexesID);
-  glDeleteBuffers(1, &faceIndexesID);
-  glDeleteBuffers(1, &vertexDataVBO);
-  glDeleteVertexArrays(1, &vertexDataVAO);
+  if (!loaded)
+    return;
+
+  auto& buffers = ModelBuffers::shared;
+  buffers.removeVertices(vertexLayout, vertexRange);
+  buffers.removeIndexes(faceRange);
+  buffers.removeIndexes(lineRange);
+
+  loaded = false;
 }
 
-glm::mat4 Model::makeEntityTransform(glm::vec3 position, glm::vec3 rotation, float scale)
+void Model::takeBuffers(Model& other)
 {
-  // apparently this way is very slow
-  //return glm::mat4()
-  //  * glm::translate(glm::mat4(), position)
-  //  * glm::rotate(glm::mat4(), rotation.z, { 0, 0, 1 })
-  //  * glm::rotate(glm::mat4(), rotation.y, { 0, 1, 0 })
-  //  * glm::rotate(glm::mat4(), rotation.x, { 1, 0, 0 })
-  //  * glm::scale(glm::mat4(), glm::vec3(scale, scale, scale));
-
-  return 
-    glm::scale(
-      glm::rotate(
-        glm::rotate(
-          glm::rotate(
-            glm::translate(glm::mat4(), position), 
-            rotation.z, { 0, 0, 1 }), 
-          rotation.y, { 0, 1, 0 }), 
-        rotation.x, { 1, 0, 0 }), 
-      glm::vec3(scale, scale, scale));
+  vertexRange = other.vertexRange;
+  lineRange = other.lineRange;
+  faceRange = other.faceRange;
+  loaded = other.loaded;
+  vertexLayout = other.vertexLayout;
+
+  other.vertexRange = {};
+  other.lineRange = {};
+  other.faceRange = {};
+  other.loaded = false;
+}
+
+void Model::updateVertices(ArrayView<const float> vertexData)
+{
+  // the data has to be packed the same way as it was at load
+  std::vector<unsigned char> packedStorage;
+  ModelBuffers::shared.updateVertices(vertexLayout, vertexRange, packVertices(vertexData, vertexLayout, packedStorage));
+}
+
+ArrayView<const float> Model::vertices() const
+{
+  if (binary.loaded())
+    return binary.vertices();
+  return vertexData;
+}
+
+ArrayView<const unsigned int> Model::faces() const
+{
+  if (binary.loaded())
+    return binary.faceIndexes();
+  return faceIndexes;
+}
+
+ArrayView<const unsigned int> Model::lines() const
+{
+  if (binary.loaded())
+    return binary.lineIndexes();
+  return lineIndexes;
 }
 
 void Model::draw_faces(DepthProgram& program, float time, glm::mat4 entityTranform)
@@ -75,12 +172,10 @@ void Model::draw_faces(DepthProgram& program, float time, glm::mat4 entityTranfo
 
   program.setModel(modelTransform);
 
-  glBindVertexArray(vertexDataVAO);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, faceIndexesID);
-  glDrawElements(GL_TRIANGLES, faceIndexes.size(), GL_UNSIGNED_INT, (void*)0);
-
-  glBindVertexArray(0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  // the vertex array stays bound for the next model, the pass unbinds it
+  ModelBuffers::shared.bind(vertexLayout);
+  auto baseVertex = (GLint)(vertexRange.offset / vertexStride(vertexLayout));
+  glDrawElementsBaseVertex(GL_TRIANGLES, faces().size(), indexType, (void*)faceRange.offset, baseVertex);
 }
 
 void Model::draw_lines(LineProgram& program, float time, glm::mat4 entityTranform)
@@ -89,13 +184,25 @@ void Model::draw_lines(LineProgram& program, float time, glm::mat4 entityTranfor
 
   program.setModel(modelTransform);
 
-  glBindVertexArray(vertexDataVAO);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lineIndexesID);
+  ModelBuffers::shared.bind(vertexLayout);
+  auto baseVertex = (GLint)(vertexRange.offset / vertexStride(vertexLayout));
   glPatchParameteri(GL_PATCH_VERTICES, 4);
-  glDrawElements(GL_PATCHES, lineIndexes.size(), GL_UNSIGNED_INT, (void*)0);
+  glDrawElementsBaseVertex(GL_PATCHES, lines().size(), indexType, (void*)lineRange.offset, baseVertex);
+}
+
+void Model::draw_faces_instanced(std::size_t baseInstance, std::size_t instanceCount)
+{
+  ModelBuffers::shared.bind(vertexLayout);
+  auto baseVertex = (GLint)(vertexRange.offset / vertexStride(vertexLayout));
+  glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, faces().size(), indexType, (void*)faceRange.offset, instanceCount, baseVertex, baseInstance);
+}
 
-  glBindVertexArray(0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+void Model::draw_lines_instanced(std::size_t baseInstance, std::size_t instanceCount)
+{
+  ModelBuffers::shared.bind(vertexLayout);
+  auto baseVertex = (GLint)(vertexRange.offset / vertexStride(vertexLayout));
+  glPatchParameteri(GL_PATCH_VERTICES, 4);
+  glDrawElementsInstancedBaseVertexBaseInstance(GL_PATCHES, lines().size(), indexType, (void*)lineRange.offset, instanceCount, baseVertex, baseInstance);
 }
 
 Entity* Model::spawn(const EntitySpawnInfo& info)
@@ -103,8 +210,11 @@ Entity* Model::spawn(const EntitySpawnInfo& info)
   return new Entity(this, info);
 }
 
-void Model::read(std::ifstream& file)
+void Model::read(TextReader& file)
 {
+  // drop any previously mapped binary so the vectors are used
+  binary.release();
+
   // get rotations
   transform = glm::scale(glm::mat4(), { 1.0f, 1.0f, 1.0f });
 
@@ -120,7 +230,46 @@ void Model::read(std::ifstream& file)
   }
 }
 
-void Model::readVersion1(Model& model, std::ifstream& file)
+bool Model::map(const std::string& filename)
+{
+  auto file = ModelFile::fromFile(filename);
+  if (!file.loaded())
+    return false;
+
+  // the mapped data is used directly, so the vectors are left empty
+  binary = std::move(file);
+  vertexData.clear();
+  faceIndexes.clear();
+  lineIndexes.clear();
+
+  transform = glm::scale(glm::mat4(), { 1.0f, 1.0f, 1.0f });
+
+  auto& header = binary.header();
+  boundingA = glm::vec3(header.boundingA[0], header.boundingA[1], header.boundingA[2]);
+  boundingB = glm::vec3(header.boundingB[0], header.boundingB[1], header.boundingB[2]);
+
+  joints.clear();
+  for (auto& joint : binary.joints())
+    joints.push_back(Joint(joint.parentIndex, glm::make_mat4(joint.transform)));
+
+  return true;
+}
+
+bool Model::write(const std::string& filename, ArrayView<const float> parameters) const
+{
+  ModelFileContents contents;
+  contents.vertices = vertices();
+  contents.faceIndexes = faces();
+  contents.lineIndexes = lines();
+  contents.joints = joints;
+  contents.parameters = parameters;
+  contents.boundingA = boundingA;
+  contents.boundingB = boundingB;
+
+  return ModelFile::write(filename, contents);
+}
+
+void Model::readVersion1(Model& model, TextReader& file)
 {
   // read vertices
   int vertexCount;
@@ -179,7 +328,7 @@ void Model::readVersion1(Model& model, std::ifstream& file)
   }
 }
 
-void Model::readVersion2(Model& model, std::ifstream& file)
+void Model::readVersion2(Model& model, TextReader& file)
 {
   // read vertices
   int vertexCount;
@@ -238,7 +387,7 @@ void Model::readVersion2(Model& model, std::ifstream& file)
   }
 }
 
-void Model::readVersion3(Model& model, std::ifstream& file)
+void Model::readVersion3(Model& model, TextReader& file)
 {
   // read bounding box
   file >> model.boundingA.x;
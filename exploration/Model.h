@@ -2,17 +2,22 @@
 #define WILT_MODEL_H
 
 #include <vector>
-#include <fstream>
+#include <string>
 
+#include <glad/glad.h>
 #include <glm/glm.hpp>
 
 #include "EntitySpawnInfo.h"
+#include "ModelFile.h"
 #include "entities/Entity.h"
 #include "graphics/joint.h"
+#include "graphics/modelBuffers.h"
+#include "graphics/skeleton.h"
 #include "graphics/programs/DepthProgram.h"
 #include "graphics/programs/LineProgram.h"
-
-constexpr int MAX_JOINTS = 24;
+#include "graphics/vertexLayout.h"
+#include "utilities/bounds.h"
+#include "utilities/textReader.h"
 
 class Model
 {
@@ -20,35 +25,55 @@ public:
   std::vector<float> vertexData;
   std::vector<unsigned int> lineIndexes;
   std::vector<unsigned int> faceIndexes;
-  unsigned int vertexDataVBO;
-  unsigned int vertexDataVAO;
-  unsigned int lineIndexesID;
-  unsigned int faceIndexesID;
+  ModelBuffers::Range vertexRange; // where the data lives in ModelBuffers::shared
+  ModelBuffers::Range lineRange;
+  ModelBuffers::Range faceRange;
+  bool loaded = false;
+  VertexLayout vertexLayout = VertexLayout::Full; // layout of the vertex range
+  GLenum indexType = GL_UNSIGNED_INT; // GL_UNSIGNED_SHORT when every index fits
   glm::mat4 transform;
   std::vector<Joint> joints;
+  Skeleton skeleton; // the joints baked for posing, set by load()
   glm::vec3 boundingA = glm::vec3(-1, -1, -1);
   glm::vec3 boundingB = glm::vec3(1, 1, 1);
+  Bounds bounds; // of the vertices, set by load() for culling
+  ModelFile binary; // backs the vertex and index data when mapped from a *_model.bin
 
 public:
-  void read(std::ifstream& file);
+  void read(TextReader& file);
+  bool map(const std::string& filename);
+  bool write(const std::string& filename, ArrayView<const float> parameters = {}) const;
   void load();
+  void reload();
   void unload();
+  void takeBuffers(Model& other);
+  void updateVertices(ArrayView<const float> vertexData);
 
-  glm::mat4 makeEntityTransform(glm::vec3 position, glm::vec3 rotation, float scale);
+  ArrayView<const float> vertices() const;
+  ArrayView<const unsigned int> faces() const;
+  ArrayView<const unsigned int> lines() const;
 
   void draw_faces(DepthProgram& program, float time, glm::mat4 entityTranform);
   void draw_lines(LineProgram& program, float time, glm::mat4 entityTranform);
 
+  // draws instances written to ModelBuffers::shared, the caller has to set the
+  // bound program to read the instance attributes
+  void draw_faces_instanced(std::size_t baseInstance, std::size_t instanceCount);
+  void draw_lines_instanced(std::size_t baseInstance, std::size_t instanceCount);
+
   virtual Entity* spawn(const EntitySpawnInfo& info);
 
 public:
-  static void readVersion1(Model& model, std::ifstream& file);
-  static void readVersion2(Model& model, std::ifstream& file);
-  static void readVersion3(Model& model, std::ifstream& file);
+  static void readVersion1(Model& model, TextReader& file);
+  static void readVersion2(Model& model, TextReader& file);
+  static void readVersion3(Model& model, TextReader& file);
 
 public:
   static const unsigned int DATA_COUNT_PER_VERTEX = 10;
 
+  // the most compact vertex layout load() may pick, Full turns packing off
+  static VertexLayout preferredLayout;
+
 }; // class Model
 
 #endif // !WILT_MODEL_H
@@ -0,0 +1,204 @@
+#include "ModelFile.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "logging/LoggingManager.h"
+namespace { auto logger = wilt::logging.createLogger("modelfile"); }
+
+namespace
+{
+  const char MAGIC[4] = { 'W', 'O', 'W', 'M' };
+  const std::uint32_t VERTEX_STRIDE = 10;
+  const std::uint64_t SECTION_ALIGNMENT = 16;
+
+  static_assert(sizeof(ModelFileHeader) == 120, "ModelFileHeader must not contain padding");
+  static_assert(sizeof(ModelFileJoint) == 68, "ModelFileJoint must not contain padding");
+
+  std::uint64_t align(std::uint64_t offset)
+  {
+    return (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+  }
+
+  bool validSection(std::uint64_t offset, std::uint64_t count, std::uint64_t size, std::uint64_t fileSize)
+  {
+    return offset % SECTION_ALIGNMENT == 0
+      && offset >= sizeof(ModelFileHeader)
+      && offset <= fileSize
+      && count <= (fileSize - offset) / size;
+  }
+}
+
+ModelFile::ModelFile()
+  : _file{ }
+  , _header{ nullptr }
+{ }
+
+ModelFile::ModelFile(ModelFile&& s)
+  : _file{ std::move(s._file) }
+  , _header{ s._header }
+{
+  s._header = nullptr;
+}
+
+ModelFile& ModelFile::operator= (ModelFile&& s)
+{
+  _file = std::move(s._file);
+  _header = s._header;
+  s._header = nullptr;
+
+  return *this;
+}
+
+const ModelFileHeader& ModelFile::header() const
+{
+  return *_header;
+}
+
+ArrayView<const float> ModelFile::vertices() const
+{
+  return { (const float*)(_file.data() + _header->vertexOffset), (std::size_t)_header->vertexCount * _header->vertexStride };
+}
+
+ArrayView<const unsigned int> ModelFile::faceIndexes() const
+{
+  return { (const unsigned int*)(_file.data() + _header->faceIndexOffset), _header->faceIndexCount };
+}
+
+ArrayView<const unsigned int> ModelFile::lineIndexes() const
+{
+  return { (const unsigned int*)(_file.data() + _header->lineIndexOffset), _header->lineIndexCount };
+}
+
+ArrayView<const ModelFileJoint> ModelFile::joints() const
+{
+  return { (const ModelFileJoint*)(_file.data() + _header->jointOffset), _header->jointCount };
+}
+
+ArrayView<const float> ModelFile::parameters() const
+{
+  return { _header->parameters, _header->parameterCount };
+}
+
+void ModelFile::release()
+{
+  _file.release();
+  _header = nullptr;
+}
+
+bool ModelFile::loaded() const
+{
+  return _header != nullptr;
+}
+
+ModelFile ModelFile::fromFile(const std::string& filename)
+{
+  ModelFile model;
+  model._file = MappedFile::fromFile(filename);
+  if (!model._file.loaded())
+    return model;
+
+  auto size = (std::uint64_t)model._file.size();
+  auto header = (const ModelFileHeader*)model._file.data();
+  if (size < sizeof(ModelFileHeader) || std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0)
+  {
+    logger.error("not a binary model: " + filename);
+    model.release();
+    return model;
+  }
+
+  if (header->version != VERSION || header->vertexStride != VERTEX_STRIDE || header->parameterCount > 8)
+  {
+    logger.error("unsupported binary model version: " + filename);
+    model.release();
+    return model;
+  }
+
+  if (!validSection(header->vertexOffset, (std::uint64_t)header->vertexCount * header->vertexStride, sizeof(float), size) ||
+      !validSection(header->faceIndexOffset, header->faceIndexCount, sizeof(unsigned int), size) ||
+      !validSection(header->lineIndexOffset, header->lineIndexCount, sizeof(unsigned int), size) ||
+      !validSection(header->jointOffset, header->jointCount, sizeof(ModelFileJoint), size))
+  {
+    logger.error("truncated binary model: " + filename);
+    model.release();
+    return model;
+  }
+
+  model._header = header;
+  return model;
+}
+
+bool ModelFile::write(const std::string& filename, const ModelFileContents& contents)
+{
+  if (contents.parameters.size() > 8)
+    return false;
+
+  ModelFileHeader header{};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.vertexStride = VERTEX_STRIDE;
+  header.parameterCount = (std::uint32_t)contents.parameters.size();
+  std::memcpy(header.parameters, contents.parameters.data(), contents.parameters.bytes());
+  std::memcpy(header.boundingA, &contents.boundingA[0], sizeof(header.boundingA));
+  std::memcpy(header.boundingB, &contents.boundingB[0], sizeof(header.boundingB));
+  header.vertexCount = (std::uint32_t)(contents.vertices.size() / VERTEX_STRIDE);
+  header.faceIndexCount = (std::uint32_t)contents.faceIndexes.size();
+  header.lineIndexCount = (std::uint32_t)contents.lineIndexes.size();
+  header.jointCount = (std::uint32_t)contents.joints.size();
+  header.vertexOffset = align(sizeof(ModelFileHeader));
+  header.faceIndexOffset = align(header.vertexOffset + contents.vertices.bytes());
+  header.lineIndexOffset = align(header.faceIndexOffset + contents.faceIndexes.bytes());
+  header.jointOffset = align(header.lineIndexOffset + contents.lineIndexes.bytes());
+
+  // the game may have the old file mapped, so the new one is written next to
+  // it and moved over it rather than truncating it in place
+  auto temporaryFilename = filename + ".tmp";
+  auto error = std::error_code();
+  std::ofstream file(temporaryFilename, std::ios::binary | std::ios::trunc);
+  if (!file)
+  {
+    logger.error("opening file for writing: " + temporaryFilename);
+    return false;
+  }
+
+  auto writeSection = [&](std::uint64_t offset, const void* data, std::size_t bytes)
+  {
+    static const char padding[SECTION_ALIGNMENT] = {};
+    file.write(padding, (std::streamsize)(offset - (std::uint64_t)file.tellp()));
+    if (bytes > 0)
+      file.write((const char*)data, (std::streamsize)bytes);
+  };
+
+  file.write((const char*)&header, sizeof(header));
+  writeSection(header.vertexOffset, contents.vertices.data(), contents.vertices.bytes());
+  writeSection(header.faceIndexOffset, contents.faceIndexes.data(), contents.faceIndexes.bytes());
+  writeSection(header.lineIndexOffset, contents.lineIndexes.data(), contents.lineIndexes.bytes());
+
+  writeSection(header.jointOffset, nullptr, 0);
+  for (auto& joint : contents.joints)
+  {
+    ModelFileJoint record;
+    record.parentIndex = joint.parentIndex();
+    std::memcpy(record.transform, &joint.transform()[0][0], sizeof(record.transform));
+    file.write((const char*)&record, sizeof(record));
+  }
+
+  file.close();
+  if (!file)
+  {
+    logger.error("writing file: " + temporaryFilename);
+    std::filesystem::remove(temporaryFilename, error);
+    return false;
+  }
+
+  std::filesystem::rename(temporaryFilename, filename, error);
+  if (error)
+  {
+    logger.error("replacing file: " + filename);
+    std::filesystem::remove(temporaryFilename, error);
+    return false;
+  }
+
+  return true;
+}
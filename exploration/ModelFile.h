@@ -0,0 +1,94 @@
+#ifndef WILT_MODELFILE_H
+#define WILT_MODELFILE_H
+
+#include <cstdint>
+#include <string>
+
+#include <glm/glm.hpp>
+
+#include "graphics/joint.h"
+#include "utilities/arrayView.h"
+#include "utilities/mappedFile.h"
+
+// The binary model container (*_model.bin) as produced by convert_model from
+// the text *_model.txt files. Everything is stored in host byte order and each
+// section starts on a 16-byte boundary, so a mapped file can be handed to the
+// GPU and to physics without being copied.
+//
+//   ModelFileHeader
+//   float          vertices[vertexCount * vertexStride]
+//   unsigned int   faceIndexes[faceIndexCount]
+//   unsigned int   lineIndexes[lineIndexCount]
+//   ModelFileJoint joints[jointCount]
+
+struct ModelFileHeader
+{
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t vertexStride;   // floats per vertex
+  std::uint32_t parameterCount; // model-type specific values, see DecorationModel
+  float parameters[8];
+  float boundingA[3];
+  float boundingB[3];
+  std::uint32_t vertexCount;
+  std::uint32_t faceIndexCount;
+  std::uint32_t lineIndexCount;
+  std::uint32_t jointCount;
+  std::uint64_t vertexOffset;
+  std::uint64_t faceIndexOffset;
+  std::uint64_t lineIndexOffset;
+  std::uint64_t jointOffset;
+};
+
+struct ModelFileJoint
+{
+  std::int32_t parentIndex;
+  float transform[16];
+};
+
+struct ModelFileContents
+{
+  ArrayView<const float> vertices;
+  ArrayView<const unsigned int> faceIndexes;
+  ArrayView<const unsigned int> lineIndexes;
+  ArrayView<const Joint> joints;
+  ArrayView<const float> parameters;
+  glm::vec3 boundingA;
+  glm::vec3 boundingB;
+};
+
+class ModelFile
+{
+private:
+  MappedFile _file;
+  const ModelFileHeader* _header;
+
+public:
+  ModelFile();
+  ModelFile(const ModelFile& s) = delete;
+  ModelFile(ModelFile&& s);
+
+  ModelFile& operator= (const ModelFile& s) = delete;
+  ModelFile& operator= (ModelFile&& s);
+
+public:
+  const ModelFileHeader& header() const;
+  ArrayView<const float> vertices() const;
+  ArrayView<const unsigned int> faceIndexes() const;
+  ArrayView<const unsigned int> lineIndexes() const;
+  ArrayView<const ModelFileJoint> joints() const;
+  ArrayView<const float> parameters() const;
+
+  void release();
+  bool loaded() const;
+
+public:
+  static ModelFile fromFile(const std::string& filename);
+  static bool write(const std::string& filename, const ModelFileContents& contents);
+
+public:
+  static const std::uint32_t VERSION = 1;
+
+}; // class ModelFile
+
+#endif // !WILT_MODELFILE_H
@@ -0,0 +1,80 @@
+#include "ModelInstances.h"
+
+#include <algorithm>
+
+#include "Model.h"
+#include "graphics/programs/DepthProgram.h"
+#include "graphics/programs/LineProgram.h"
+
+void ModelInstances::add(Model* model, const glm::mat4& entityTransform, float drawPercentage)
+{
+  // there are only a handful of instanced models, a search is fine
+  auto found = std::find(_models.begin(), _models.end(), model);
+  auto index = (std::size_t)(found - _models.begin());
+  if (found == _models.end())
+  {
+    _models.push_back(model);
+    _instances.emplace_back();
+  }
+
+  ModelInstance instance;
+  instance.transform = entityTransform * model->transform;
+  instance.drawPercentage = drawPercentage;
+  _instances[index].push_back(instance);
+}
+
+void ModelInstances::draw_faces(DepthProgram& program)
+{
+  if (!upload())
+    return;
+
+  program.setSkinned(false);
+  program.setInstanced(true);
+
+  std::size_t baseInstance = 0;
+  for (std::size_t i = 0; i < _models.size(); ++i)
+  {
+    if (_counts[i] > 0)
+      _models[i]->draw_faces_instanced(baseInstance, _counts[i]);
+    baseInstance += _counts[i];
+  }
+
+  program.setInstanced(false);
+}
+
+void ModelInstances::draw_lines(LineProgram& program)
+{
+  if (!upload())
+    return;
+
+  program.setSkinned(false);
+  program.setInstanced(true);
+
+  std::size_t baseInstance = 0;
+  for (std::size_t i = 0; i < _models.size(); ++i)
+  {
+    if (_counts[i] > 0)
+      _models[i]->draw_lines_instanced(baseInstance, _counts[i]);
+    baseInstance += _counts[i];
+  }
+
+  program.setInstanced(false);
+}
+
+bool ModelInstances::upload()
+{
+  _combined.clear();
+  _counts.clear();
+  for (auto& instances : _instances)
+  {
+    _combined.insert(_combined.end(), instances.begin(), instances.end());
+    _counts.push_back(instances.size());
+    instances.clear();
+  }
+
+  if (_combined.empty())
+    return false;
+
+  ModelBuffers::shared.writeInstances(_combined);
+  return true;
+}
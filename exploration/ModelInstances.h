@@ -0,0 +1,39 @@
+#ifndef WILT_MODELINSTANCES_H
+#define WILT_MODELINSTANCES_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "graphics/modelBuffers.h"
+
+class Model;
+class DepthProgram;
+class LineProgram;
+
+// Collects entities that are drawn as instances of their model during a pass,
+// then draws each model once for all of them. Entities add themselves from
+// their draw_faces/draw_lines and the pass calls draw_faces/draw_lines after
+// every entity has had its turn.
+class ModelInstances
+{
+private:
+  std::vector<Model*> _models;
+  std::vector<std::vector<ModelInstance>> _instances; // per model, in the same order
+  std::vector<ModelInstance> _combined;
+  std::vector<std::size_t> _counts; // per model, as last uploaded
+
+public:
+  void add(Model* model, const glm::mat4& entityTransform, float drawPercentage);
+
+  void draw_faces(DepthProgram& program);
+  void draw_lines(LineProgram& program);
+
+private:
+  // writes every model's instances to the instance buffer back to back and
+  // forgets them, the draws follow the same order
+  bool upload();
+
+}; // class ModelInstances
+
+#endif // !WILT_MODELINSTANCES_H
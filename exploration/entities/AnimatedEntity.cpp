@@ -1,22 +1,89 @@
 #include "AnimatedEntity.h"
 
+#include <algorithm>
+#include <limits>
+
 AnimatedEntity::AnimatedEntity(Model* model, const EntitySpawnInfo& info, IAnimator* animator)
   : Entity{ model, info }
   , animator{ animator }
+  , paletteOffset{ 0 }
+  , poseFrom{}
+  , poseTo{}
+  , poseFromTime{ std::numeric_limits<float>::quiet_NaN() }
+  , poseToTime{ std::numeric_limits<float>::quiet_NaN() }
 { }
 
+std::size_t AnimatedEntity::jointCount() const
+{
+  return std::max(model->skeleton.size(), std::size_t(1));
+}
+
+void AnimatedEntity::pose(glm::mat4* transforms, float time, float interval)
+{
+  auto count = jointCount();
+  if (poseTo.size() != count)
+  {
+    // only on the first pose or when the model is reloaded
+    poseFrom.assign(count, glm::mat4());
+    poseTo.assign(count, glm::mat4());
+    poseFromTime = std::numeric_limits<float>::quiet_NaN();
+    poseToTime = std::numeric_limits<float>::quiet_NaN();
+  }
+
+  if (interval <= 0.0f)
+  {
+    if (time != poseToTime || poseFromTime != poseToTime)
+    {
+      animator->applyAnimation(time, model->skeleton, poseTo.data());
+      poseFromTime = time;
+      poseToTime = time;
+    }
+
+    std::copy(poseTo.begin(), poseTo.end(), transforms);
+    return;
+  }
+
+  // some slack so rounding in the times doesn't put a sample a frame late
+  auto slack = interval / 16.0f;
+  auto sampling = poseToTime > poseFromTime;
+  if (sampling && time + slack > poseToTime && time <= poseToTime + interval)
+  {
+    // passed the next sample, it becomes the previous one
+    std::swap(poseFrom, poseTo);
+    poseFromTime = poseToTime;
+    poseToTime = poseFromTime + interval;
+    animator->applyAnimation(poseToTime, model->skeleton, poseTo.data());
+  }
+  else if (!(sampling && time + slack >= poseFromTime && time <= poseToTime))
+  {
+    // the first pose, back in view or coming from full rate, sampling starts
+    // over from here. The first sample comes after a quarter to all of the
+    // interval so entities that start together don't all sample together.
+    poseFromTime = time;
+    poseToTime = time + interval * (transformSlot % 4 + 1) / 4.0f;
+    animator->applyAnimation(poseFromTime, model->skeleton, poseFrom.data());
+    animator->applyAnimation(poseToTime, model->skeleton, poseTo.data());
+  }
+
+  auto blend = std::clamp((time - poseFromTime) / (poseToTime - poseFromTime), 0.0f, 1.0f);
+  for (std::size_t i = 0; i < count; ++i)
+    transforms[i] = poseFrom[i] * (1.0f - blend) + poseTo[i] * blend;
+}
+
 void AnimatedEntity::draw_faces(GameState& state, DepthProgram& program, float time)
 {
-  animator->applyAnimation(program, time, model->joints);
+  program.setSkinned(true);
+  program.setPaletteOffset(paletteOffset);
   program.setDrawPercentage(1.0f);
-  model->draw_faces(program, time, model->makeEntityTransform(position, rotation, scale));
+  model->draw_faces(program, time, transform());
 }
 
 void AnimatedEntity::draw_lines(GameState& state, LineProgram& program, float time)
 {
-  animator->applyAnimation(program, time, model->joints);
+  program.setSkinned(true);
+  program.setPaletteOffset(paletteOffset);
   program.setDrawPercentage(1.0f);
-  model->draw_lines(program, time, model->makeEntityTransform(position, rotation, scale));
+  model->draw_lines(program, time, transform());
 }
 
 void AnimatedEntity::draw_debug(GameState& state, DebugProgram& program, float time)
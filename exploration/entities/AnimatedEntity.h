@@ -1,6 +1,9 @@
 #ifndef WILT_ANIMATEDENTITY_H
 #define WILT_ANIMATEDENTITY_H
 
+#include <cstddef>
+#include <vector>
+
 #include "Entity.h"
 #include "../graphics/IAnimator.h"
 
@@ -8,10 +11,27 @@ class AnimatedEntity : public Entity
 {
 public:
   IAnimator* animator;
+  int paletteOffset; // of this frame's joints in the JointPalette
+
+  // the poses the drawn one is blended between, at full rate both are the
+  // pose at the last time it was posed
+  std::vector<glm::mat4> poseFrom;
+  std::vector<glm::mat4> poseTo;
+  float poseFromTime;
+  float poseToTime;
 
 public:
   AnimatedEntity(Model* model, const EntitySpawnInfo& info, IAnimator* animator);
 
+public:
+  // one even without joints, the vertices still index joint 0
+  std::size_t jointCount() const;
+
+  // writes the pose at time into transforms, running the animator at most
+  // once every interval and blending the transforms in between (every time
+  // it moves if interval is 0). Called from AnimationSystem's workers.
+  void pose(glm::mat4* transforms, float time, float interval);
+
 public:
   // Entity overrides
   void draw_faces(GameState& state, DepthProgram& program, float time) override;
@@ -0,0 +1,45 @@
+#include "AnimationSystem.h"
+
+#include <algorithm>
+
+#include "AnimatedEntity.h"
+
+AnimationSystem::AnimationSystem(float frameTime)
+  : _workers{ }
+  , _frameTime{ frameTime }
+  , _jobs{ }
+{ }
+
+std::size_t AnimationSystem::pose(const std::vector<Entity*>& entities, const glm::vec3& cameraPosition, float time, JointPalette& palette)
+{
+  _jobs.clear();
+  for (auto entity : entities)
+  {
+    auto animated = dynamic_cast<AnimatedEntity*>(entity);
+    if (!animated)
+      continue;
+
+    auto distance = glm::length(animated->position - cameraPosition);
+    auto interval = distance < FULL_RATE_DISTANCE ? 0.0f : REDUCED_RATE * _frameTime;
+
+    animated->paletteOffset = palette.allocate((int)animated->jointCount());
+    _jobs.push_back(Job{ animated, interval });
+  }
+
+  // the palette doesn't move once everything is allocated, so the workers can
+  // each write their own entities' ranges
+  for (std::size_t first = 0; first < _jobs.size(); first += BATCH_SIZE)
+  {
+    auto last = std::min(first + BATCH_SIZE, _jobs.size());
+    _workers.submit([this, first, last, time, &palette] {
+      for (auto i = first; i < last; ++i)
+      {
+        auto& job = _jobs[i];
+        job.entity->pose(palette.transforms(job.entity->paletteOffset), time, job.interval);
+      }
+    });
+  }
+  _workers.wait();
+
+  return _jobs.size();
+}
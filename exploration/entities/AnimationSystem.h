@@ -0,0 +1,50 @@
+#ifndef WILT_ANIMATIONSYSTEM_H
+#define WILT_ANIMATIONSYSTEM_H
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../graphics/jointPalette.h"
+#include "../utilities/workerPool.h"
+
+class Entity;
+class AnimatedEntity;
+
+// Poses the animated entities that are going to be drawn, spread over worker
+// threads. The palette ranges are handed out up front so each entity only
+// writes its own. Entities further than FULL_RATE_DISTANCE from the camera run
+// their animator every REDUCED_RATE frames and blend in between, and entities
+// that aren't drawn aren't posed at all.
+class AnimationSystem
+{
+private:
+  struct Job
+  {
+    AnimatedEntity* entity;
+    float interval;
+  };
+
+  WorkerPool _workers;
+  float _frameTime;
+  std::vector<Job> _jobs;
+
+public:
+  // frameTime is how far time moves each frame
+  explicit AnimationSystem(float frameTime);
+  AnimationSystem(const AnimationSystem& s) = delete;
+  AnimationSystem& operator= (const AnimationSystem& s) = delete;
+
+public:
+  // returns how many of the entities were animated
+  std::size_t pose(const std::vector<Entity*>& entities, const glm::vec3& cameraPosition, float time, JointPalette& palette);
+
+public:
+  static constexpr float FULL_RATE_DISTANCE = 25.0f;
+  static const int REDUCED_RATE = 4; // frames between samples
+  static const std::size_t BATCH_SIZE = 16; // entities per task
+
+}; // class AnimationSystem
+
+#endif // !WILT_ANIMATIONSYSTEM_H
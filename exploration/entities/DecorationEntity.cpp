@@ -11,7 +11,6 @@ DecorationEntity::DecorationEntity(Model* model, const EntitySpawnInfo& info)
   : Entity{ model, info }
   , drawPercentage{ 0.0f }
   , drawState{ HIDDEN }
-  , transform{ model->makeEntityTransform(position, rotation, scale)}
 {
 
 }
@@ -62,10 +61,7 @@ void DecorationEntity::draw_faces(GameState& state, DepthProgram& program, float
   if (drawPercentage <= 0.0f)
     return;
 
-  std::array<glm::mat4, MAX_JOINTS> jointTransforms;
-  program.setPositions(jointTransforms);
-  program.setDrawPercentage(drawPercentage);
-  model->draw_faces(program, time, transform);
+  state.instances.add(model, transform(), drawPercentage);
 }
 
 void DecorationEntity::draw_lines(GameState& state, LineProgram& program, float time)
@@ -73,10 +69,7 @@ void DecorationEntity::draw_lines(GameState& state, LineProgram& program, float
   if (drawPercentage <= 0.0f)
     return;
 
-  std::array<glm::mat4, MAX_JOINTS> jointTransforms;
-  program.setPositions(jointTransforms);
-  program.setDrawPercentage(drawPercentage);
-  model->draw_lines(program, time, transform);
+  state.instances.add(model, transform(), drawPercentage);
 }
 
 void DecorationEntity::draw_debug(GameState& state, DebugProgram& program, float time)
@@ -84,7 +77,7 @@ void DecorationEntity::draw_debug(GameState& state, DebugProgram& program, float
   if (drawPercentage <= 0.0f)
     return;
 
-  auto entityTransform = transform * model->transform;
+  auto entityTransform = transform() * model->transform;
 
   auto percentage = drawPercentage > 1.0f ? 1.0f : drawPercentage;
   auto offsetBox = (model->boundingA + model->boundingB) / 2.0f;
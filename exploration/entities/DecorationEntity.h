@@ -20,8 +20,6 @@ public:
   float drawPercentage = 0.0f;
   DecorationState drawState = HIDDEN;
 
-  glm::mat4 transform;
-
 public:
   DecorationEntity(Model* model, const EntitySpawnInfo& info);
 
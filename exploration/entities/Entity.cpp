@@ -5,27 +5,49 @@ Entity::Entity(Model* model, const EntitySpawnInfo& info)
   , position{ info.location}
   , rotation{ info.rotation }
   , scale{ info.scale.x }       // TODO: use full scale info
-{ }
+  , transformSlot{ EntityTransforms::shared.add() }
+  , treeNode{ EntityTree::NONE }
+{
+  EntityTransforms::shared.update(transformSlot, position, rotation, scale);
+}
+
+Entity::~Entity()
+{
+  EntityTransforms::shared.remove(transformSlot);
+}
 
 void Entity::update(GameState& state, float time)
 {
 
 }
 
+void Entity::updateTransforms()
+{
+  EntityTransforms::shared.update(transformSlot, position, rotation, scale);
+}
+
+const glm::mat4& Entity::transform() const
+{
+  return EntityTransforms::shared[transformSlot];
+}
+
+Bounds Entity::bounds() const
+{
+  return model->bounds.transformed(transform() * model->transform);
+}
+
 void Entity::draw_faces(GameState& state, DepthProgram& program, float time)
 {
-  std::array<glm::mat4, MAX_JOINTS> jointTransforms;
-  program.setPositions(jointTransforms);
+  program.setSkinned(false);
   program.setDrawPercentage(1.0f);
-  model->draw_faces(program, time, model->makeEntityTransform(position, rotation, scale)); // TODO: store the transform so that it isn't duplicated between rendering stages
+  model->draw_faces(program, time, transform());
 }
 
 void Entity::draw_lines(GameState& state, LineProgram& program, float time)
 {
-  std::array<glm::mat4, MAX_JOINTS> jointTransforms;
-  program.setPositions(jointTransforms);
+  program.setSkinned(false);
   program.setDrawPercentage(1.0f);
-  model->draw_lines(program, time, model->makeEntityTransform(position, rotation, scale));
+  model->draw_lines(program, time, transform());
 }
 
 void Entity::draw_debug(GameState& state, DebugProgram& program, float time)
@@ -1,11 +1,14 @@
 #ifndef WILT_ENTITY_H
 #define WILT_ENTITY_H
 
+#include <cstddef>
 
 #include <glm/glm.hpp>
 
 #include "../EntitySpawnInfo.h"
 #include "GameState.h"
+#include "EntityTree.h"
+#include "../utilities/bounds.h"
 
 class IAnimator;
 class Model;
@@ -20,17 +23,29 @@ public:
   glm::vec3 position;
   glm::vec3 rotation;
   float scale;
+  std::size_t transformSlot; // in EntityTransforms::shared
+  int treeNode; // in GameState::entityTree, EntityTree::NONE until added
 
   Entity(Model* model, const EntitySpawnInfo& info);
+  virtual ~Entity();
 
   virtual void update(GameState& state, float time);
 
+  // called once a frame after the entities update, before they're drawn
+  virtual void updateTransforms();
+  const glm::mat4& transform() const;
+
+  // world-space box around what draw_faces and draw_lines draw, used to skip
+  // entities that are off screen
+  virtual Bounds bounds() const;
+
   virtual void draw_faces(GameState& state, DepthProgram& program, float time);
   virtual void draw_lines(GameState& state, LineProgram& program, float time);
   virtual void draw_debug(GameState& state, DebugProgram& program, float time);
 
 }; // class Entity
 
+#include "EntityTransforms.h"
 #include "Model.h"
 #include "../graphics/programs/DepthProgram.h"
 #include "../graphics/programs/LineProgram.h"
@@ -0,0 +1,247 @@
+#include "EntityTransforms.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WILT_TRANSFORMS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+  const std::size_t GROUP_SIZE = 4;
+
+  // rotation about z, then y, then x, expanded, with the scale folded in
+  void buildTransform(float px, float py, float pz, float sx, float cx, float sy, float cy, float sz, float cz, float s, glm::mat4& transform)
+  {
+    transform[0] = glm::vec4(cz * cy * s, sz * cy * s, -sy * s, 0.0f);
+    transform[1] = glm::vec4((cz * sy * sx - sz * cx) * s, (sz * sy * sx + cz * cx) * s, cy * sx * s, 0.0f);
+    transform[2] = glm::vec4((cz * sy * cx + sz * sx) * s, (sz * sy * cx - cz * sx) * s, cy * cx * s, 0.0f);
+    transform[3] = glm::vec4(px, py, pz, 1.0f);
+  }
+
+  void buildScalar(const TransformInputs& inputs, std::size_t first, std::size_t count, glm::mat4* transforms)
+  {
+    for (auto i = first; i < first + count; ++i)
+    {
+      buildTransform(
+        inputs.positionX[i], inputs.positionY[i], inputs.positionZ[i],
+        std::sin(inputs.rotationX[i]), std::cos(inputs.rotationX[i]),
+        std::sin(inputs.rotationY[i]), std::cos(inputs.rotationY[i]),
+        std::sin(inputs.rotationZ[i]), std::cos(inputs.rotationZ[i]),
+        inputs.scale[i], transforms[i]);
+    }
+  }
+
+#ifdef WILT_TRANSFORMS_SSE2
+  // Cephes' single precision sine and cosine, four at a time. The angle is
+  // reduced by multiples of pi/2 (split in three so the reduction stays exact
+  // for angles up to a few thousand radians) to within pi/4, where both
+  // polynomials are accurate to about an ulp, and the quadrant picks which
+  // polynomial is which and their signs.
+  void sincos(__m128 x, __m128& sine, __m128& cosine)
+  {
+    const auto TWO_OVER_PI = _mm_set1_ps(0.636619772367581343f);
+    const auto PI_OVER_2_A = _mm_set1_ps(1.5703125f);
+    const auto PI_OVER_2_B = _mm_set1_ps(4.837512969970703125e-4f);
+    const auto PI_OVER_2_C = _mm_set1_ps(7.54978995489188216e-8f);
+
+    auto quadrant = _mm_cvtps_epi32(_mm_mul_ps(x, TWO_OVER_PI));
+    auto multiple = _mm_cvtepi32_ps(quadrant);
+    auto r = _mm_sub_ps(x, _mm_mul_ps(multiple, PI_OVER_2_A));
+    r = _mm_sub_ps(r, _mm_mul_ps(multiple, PI_OVER_2_B));
+    r = _mm_sub_ps(r, _mm_mul_ps(multiple, PI_OVER_2_C));
+    auto r2 = _mm_mul_ps(r, r);
+
+    auto s = _mm_set1_ps(-1.9515295891e-4f);
+    s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(8.3321608736e-3f));
+    s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.6666654611e-1f));
+    s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+
+    auto c = _mm_set1_ps(2.443315711809948e-5f);
+    c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(-1.388731625493765e-3f));
+    c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(4.166664568298827e-2f));
+    c = _mm_mul_ps(_mm_mul_ps(c, r2), r2);
+    c = _mm_add_ps(_mm_sub_ps(c, _mm_mul_ps(r2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+    // odd quadrants swap the two, sine is negated in quadrants 2 and 3 and
+    // cosine in quadrants 1 and 2
+    auto one = _mm_set1_epi32(1);
+    auto two = _mm_set1_epi32(2);
+    auto swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+    auto sineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+    auto cosineSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+
+    sine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), sineSign);
+    cosine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), cosineSign);
+  }
+
+  // builds four transforms, each lane of the inputs is one entity, and the
+  // matrix elements come out the same way so each column is transposed back
+  // into the four matrices
+  void buildGroup(const TransformInputs& inputs, std::size_t first, glm::mat4* transforms)
+  {
+    __m128 sx, cx, sy, cy, sz, cz;
+    sincos(_mm_loadu_ps(inputs.rotationX + first), sx, cx);
+    sincos(_mm_loadu_ps(inputs.rotationY + first), sy, cy);
+    sincos(_mm_loadu_ps(inputs.rotationZ + first), sz, cz);
+    auto s = _mm_loadu_ps(inputs.scale + first);
+
+    auto czs = _mm_mul_ps(cz, s);
+    auto szs = _mm_mul_ps(sz, s);
+    auto cys = _mm_mul_ps(cy, s);
+    auto czsy = _mm_mul_ps(czs, sy);
+    auto szsy = _mm_mul_ps(szs, sy);
+
+    __m128 columns[4][4] = {
+      { _mm_mul_ps(czs, cy), _mm_mul_ps(szs, cy), _mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(sy, s)), _mm_setzero_ps() },
+      { _mm_sub_ps(_mm_mul_ps(czsy, sx), _mm_mul_ps(szs, cx)), _mm_add_ps(_mm_mul_ps(szsy, sx), _mm_mul_ps(czs, cx)), _mm_mul_ps(cys, sx), _mm_setzero_ps() },
+      { _mm_add_ps(_mm_mul_ps(czsy, cx), _mm_mul_ps(szs, sx)), _mm_sub_ps(_mm_mul_ps(szsy, cx), _mm_mul_ps(czs, sx)), _mm_mul_ps(cys, cx), _mm_setzero_ps() },
+      { _mm_loadu_ps(inputs.positionX + first), _mm_loadu_ps(inputs.positionY + first), _mm_loadu_ps(inputs.positionZ + first), _mm_set1_ps(1.0f) },
+    };
+
+    for (int column = 0; column < 4; ++column)
+    {
+      auto& c = columns[column];
+      _MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+      for (int lane = 0; lane < 4; ++lane)
+        _mm_storeu_ps(&transforms[first + lane][column][0], c[lane]);
+    }
+  }
+#endif
+}
+
+EntityTransforms EntityTransforms::shared;
+
+std::size_t EntityTransforms::add()
+{
+  if (!_free.empty())
+  {
+    auto slot = _free.back();
+    _free.pop_back();
+    _dirty[slot] = true;
+    return slot;
+  }
+
+  _positionX.push_back(0.0f);
+  _positionY.push_back(0.0f);
+  _positionZ.push_back(0.0f);
+  _rotationX.push_back(0.0f);
+  _rotationY.push_back(0.0f);
+  _rotationZ.push_back(0.0f);
+  _scale.push_back(0.0f);
+  _dirty.push_back(true);
+  _transforms.emplace_back();
+  return _transforms.size() - 1;
+}
+
+void EntityTransforms::remove(std::size_t slot)
+{
+  _free.push_back(slot);
+}
+
+void EntityTransforms::update(std::size_t slot, const glm::vec3& position, const glm::vec3& rotation, float scale)
+{
+  if (_positionX[slot] == position.x && _positionY[slot] == position.y && _positionZ[slot] == position.z &&
+      _rotationX[slot] == rotation.x && _rotationY[slot] == rotation.y && _rotationZ[slot] == rotation.z &&
+      _scale[slot] == scale)
+    return;
+
+  _positionX[slot] = position.x;
+  _positionY[slot] = position.y;
+  _positionZ[slot] = position.z;
+  _rotationX[slot] = rotation.x;
+  _rotationY[slot] = rotation.y;
+  _rotationZ[slot] = rotation.z;
+  _scale[slot] = scale;
+  _dirty[slot] = true;
+}
+
+void EntityTransforms::build()
+{
+  auto inputs = TransformInputs{
+    _positionX.data(), _positionY.data(), _positionZ.data(),
+    _rotationX.data(), _rotationY.data(), _rotationZ.data(),
+    _scale.data()
+  };
+
+  // whole groups of four are rebuilt if any of them changed, and neighbouring
+  // groups that need it are rebuilt together
+  auto size = _transforms.size();
+  auto groupDirty = [&](std::size_t group)
+  {
+    auto end = std::min(size, (group + 1) * GROUP_SIZE);
+    return std::any_of(_dirty.begin() + group * GROUP_SIZE, _dirty.begin() + end, [](unsigned char dirty) { return dirty != 0; });
+  };
+
+  auto groups = (size + GROUP_SIZE - 1) / GROUP_SIZE;
+  for (std::size_t group = 0; group < groups; )
+  {
+    if (!groupDirty(group))
+    {
+      group += 1;
+      continue;
+    }
+
+    auto first = group;
+    while (group < groups && groupDirty(group))
+      group += 1;
+
+    auto begin = first * GROUP_SIZE;
+    auto end = std::min(size, group * GROUP_SIZE);
+    buildTransforms(
+      TransformInputs{
+        inputs.positionX + begin, inputs.positionY + begin, inputs.positionZ + begin,
+        inputs.rotationX + begin, inputs.rotationY + begin, inputs.rotationZ + begin,
+        inputs.scale + begin },
+      end - begin, _transforms.data() + begin);
+    std::fill(_dirty.begin() + begin, _dirty.begin() + end, 0);
+  }
+}
+
+const glm::mat4& EntityTransforms::operator[](std::size_t slot) const
+{
+  return _transforms[slot];
+}
+
+ArrayView<const glm::mat4> EntityTransforms::transforms() const
+{
+  return _transforms;
+}
+
+glm::mat4 EntityTransforms::makeTransform(const glm::vec3& position, const glm::vec3& rotation, float scale)
+{
+  // apparently this way is very slow
+  //return glm::mat4()
+  //  * glm::translate(glm::mat4(), position)
+  //  * glm::rotate(glm::mat4(), rotation.z, { 0, 0, 1 })
+  //  * glm::rotate(glm::mat4(), rotation.y, { 0, 1, 0 })
+  //  * glm::rotate(glm::mat4(), rotation.x, { 1, 0, 0 })
+  //  * glm::scale(glm::mat4(), glm::vec3(scale, scale, scale));
+
+  return 
+    glm::scale(
+      glm::rotate(
+        glm::rotate(
+          glm::rotate(
+            glm::translate(glm::mat4(), position), 
+            rotation.z, { 0, 0, 1 }), 
+          rotation.y, { 0, 1, 0 }), 
+        rotation.x, { 1, 0, 0 }), 
+      glm::vec3(scale, scale, scale));
+}
+
+void EntityTransforms::buildTransforms(const TransformInputs& inputs, std::size_t count, glm::mat4* transforms)
+{
+  std::size_t i = 0;
+
+#ifdef WILT_TRANSFORMS_SSE2
+  for (; i + GROUP_SIZE <= count; i += GROUP_SIZE)
+    buildGroup(inputs, i, transforms);
+#endif
+
+  buildScalar(inputs, i, count - i, transforms);
+}
@@ -0,0 +1,65 @@
+#ifndef WILT_ENTITYTRANSFORMS_H
+#define WILT_ENTITYTRANSFORMS_H
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../utilities/arrayView.h"
+
+// Positions, rotations and scales to build transforms from, one array per
+// component.
+struct TransformInputs
+{
+  const float* positionX;
+  const float* positionY;
+  const float* positionZ;
+  const float* rotationX;
+  const float* rotationY;
+  const float* rotationZ;
+  const float* scale;
+};
+
+// Entity transforms, kept side by side. Each entity owns one or more slots
+// and updates their inputs once a frame after it moves, then build() rebuilds
+// the matrices of the slots whose position, rotation or scale changed, four
+// at a time. The render passes (and anything else that wants the transforms)
+// read them from here.
+class EntityTransforms
+{
+private:
+  std::vector<float> _positionX;
+  std::vector<float> _positionY;
+  std::vector<float> _positionZ;
+  std::vector<float> _rotationX;
+  std::vector<float> _rotationY;
+  std::vector<float> _rotationZ;
+  std::vector<float> _scale;
+  std::vector<unsigned char> _dirty;
+  std::vector<glm::mat4> _transforms;
+  std::vector<std::size_t> _free;
+
+public:
+  std::size_t add();
+  void remove(std::size_t slot);
+
+  void update(std::size_t slot, const glm::vec3& position, const glm::vec3& rotation, float scale);
+  void build();
+
+  const glm::mat4& operator[](std::size_t slot) const;
+  ArrayView<const glm::mat4> transforms() const;
+
+public:
+  // translate, then rotate about z, y and x, then scale
+  static glm::mat4 makeTransform(const glm::vec3& position, const glm::vec3& rotation, float scale);
+
+  // the same as makeTransform for count inputs at once, using SSE2 where
+  // available (the sines and cosines are computed in the vector lanes too)
+  static void buildTransforms(const TransformInputs& inputs, std::size_t count, glm::mat4* transforms);
+
+  static EntityTransforms shared;
+
+}; // class EntityTransforms
+
+#endif // !WILT_ENTITYTRANSFORMS_H
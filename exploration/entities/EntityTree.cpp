@@ -0,0 +1,344 @@
+#include "EntityTree.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "Entity.h"
+
+namespace
+{
+  float surfaceArea(const Bounds& bounds)
+  {
+    auto size = bounds.max - bounds.min;
+    return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+  }
+
+  // slab test, the distance along the ray where it enters the box (0 if it
+  // starts inside) or a negative value if it misses
+  float rayDistance(const Bounds& bounds, const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance)
+  {
+    auto t1 = (bounds.min - origin) * inverseDirection;
+    auto t2 = (bounds.max - origin) * inverseDirection;
+    auto tmin = glm::min(t1, t2);
+    auto tmax = glm::max(t1, t2);
+
+    auto enter = std::max(std::max(tmin.x, tmin.y), std::max(tmin.z, 0.0f));
+    auto exit = std::min(std::min(tmax.x, tmax.y), std::min(tmax.z, maxDistance));
+
+    return enter <= exit ? enter : -1.0f;
+  }
+
+  bool sphereIntersects(const Bounds& bounds, const glm::vec3& center, float radius)
+  {
+    auto closest = glm::clamp(center, bounds.min, bounds.max);
+    auto offset = closest - center;
+    return glm::dot(offset, offset) <= radius * radius;
+  }
+}
+
+EntityTree::EntityTree()
+  : _root{ NONE }
+  , _free{ NONE }
+{ }
+
+void EntityTree::update(Entity* entity)
+{
+  auto bounds = entity->bounds();
+
+  if (entity->treeNode != NONE)
+  {
+    auto& node = _nodes[entity->treeNode];
+    node.exact = bounds;
+    if (node.bounds.contains(bounds))
+      return;
+
+    removeLeaf(entity->treeNode);
+  }
+  else
+  {
+    entity->treeNode = allocateNode();
+  }
+
+  auto& node = _nodes[entity->treeNode];
+  node.bounds = bounds.grown(glm::vec3(MARGIN));
+  node.exact = bounds;
+  node.entity = entity;
+  node.height = 0;
+  insertLeaf(entity->treeNode);
+}
+
+void EntityTree::remove(Entity* entity)
+{
+  if (entity->treeNode == NONE)
+    return;
+
+  removeLeaf(entity->treeNode);
+  freeNode(entity->treeNode);
+  entity->treeNode = NONE;
+}
+
+void EntityTree::queryFrustum(const Frustum& frustum, std::vector<Entity*>& results) const
+{
+  query([&](const Bounds& bounds) { return frustum.intersects(bounds); }, results);
+}
+
+void EntityTree::querySphere(const glm::vec3& center, float radius, std::vector<Entity*>& results) const
+{
+  query([&](const Bounds& bounds) { return sphereIntersects(bounds, center, radius); }, results);
+}
+
+void EntityTree::queryBounds(const Bounds& bounds, std::vector<Entity*>& results) const
+{
+  query([&](const Bounds& other) { return bounds.intersects(other); }, results);
+}
+
+EntityTree::RayHit EntityTree::raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const
+{
+  auto hit = RayHit{ nullptr, maxDistance };
+  if (_root == NONE)
+    return hit;
+
+  // dividing by zero gives infinities, which the slab test handles
+  auto inverseDirection = 1.0f / direction;
+
+  // nodes further away than the closest hit so far are skipped
+  std::vector<int> stack{ _root };
+  while (!stack.empty())
+  {
+    auto index = stack.back();
+    stack.pop_back();
+
+    auto& node = _nodes[index];
+    if (rayDistance(node.bounds, origin, inverseDirection, hit.distance) < 0.0f)
+      continue;
+
+    if (node.leaf())
+    {
+      auto distance = rayDistance(node.exact, origin, inverseDirection, hit.distance);
+      if (distance >= 0.0f)
+        hit = RayHit{ node.entity, distance };
+      continue;
+    }
+
+    stack.push_back(node.children[0]);
+    stack.push_back(node.children[1]);
+  }
+
+  return hit;
+}
+
+int EntityTree::height() const
+{
+  return _root == NONE ? 0 : _nodes[_root].height;
+}
+
+int EntityTree::allocateNode()
+{
+  if (_free == NONE)
+  {
+    _nodes.push_back(Node{});
+    _nodes.back().parent = _free;
+    _nodes.back().height = -1;
+    _free = (int)_nodes.size() - 1;
+  }
+
+  auto index = _free;
+  auto& node = _nodes[index];
+  _free = node.parent;
+
+  node.entity = nullptr;
+  node.parent = NONE;
+  node.children[0] = NONE;
+  node.children[1] = NONE;
+  node.height = 0;
+  return index;
+}
+
+void EntityTree::freeNode(int index)
+{
+  auto& node = _nodes[index];
+  node.entity = nullptr;
+  node.parent = _free;
+  node.height = -1;
+  _free = index;
+}
+
+void EntityTree::insertLeaf(int leaf)
+{
+  if (_root == NONE)
+  {
+    _root = leaf;
+    _nodes[leaf].parent = NONE;
+    return;
+  }
+
+  // walk down to the sibling that adds the least surface area, which is what
+  // keeps queries from visiting more of the tree than they have to
+  auto leafBounds = _nodes[leaf].bounds;
+  auto index = _root;
+  while (!_nodes[index].leaf())
+  {
+    auto& node = _nodes[index];
+    auto area = surfaceArea(node.bounds);
+    auto combinedArea = surfaceArea(node.bounds.merged(leafBounds));
+
+    // the cost of pairing with this node, and what pushing the leaf further
+    // down adds to every node on the way
+    auto cost = 2.0f * combinedArea;
+    auto inheritedCost = 2.0f * (combinedArea - area);
+
+    auto childCost = [&](int child)
+    {
+      auto& childNode = _nodes[child];
+      auto mergedArea = surfaceArea(childNode.bounds.merged(leafBounds));
+      if (childNode.leaf())
+        return mergedArea + inheritedCost;
+      return mergedArea - surfaceArea(childNode.bounds) + inheritedCost;
+    };
+
+    auto cost0 = childCost(node.children[0]);
+    auto cost1 = childCost(node.children[1]);
+    if (cost < cost0 && cost < cost1)
+      break;
+
+    index = cost0 < cost1 ? node.children[0] : node.children[1];
+  }
+
+  auto sibling = index;
+  auto oldParent = _nodes[sibling].parent;
+  auto newParent = allocateNode();
+
+  _nodes[newParent].parent = oldParent;
+  _nodes[newParent].bounds = _nodes[sibling].bounds.merged(leafBounds);
+  _nodes[newParent].height = _nodes[sibling].height + 1;
+  _nodes[newParent].children[0] = sibling;
+  _nodes[newParent].children[1] = leaf;
+  _nodes[sibling].parent = newParent;
+  _nodes[leaf].parent = newParent;
+
+  if (oldParent == NONE)
+    _root = newParent;
+  else if (_nodes[oldParent].children[0] == sibling)
+    _nodes[oldParent].children[0] = newParent;
+  else
+    _nodes[oldParent].children[1] = newParent;
+
+  refit(_nodes[leaf].parent);
+}
+
+void EntityTree::removeLeaf(int leaf)
+{
+  if (leaf == _root)
+  {
+    _root = NONE;
+    return;
+  }
+
+  // the parent goes away and the sibling takes its place
+  auto parent = _nodes[leaf].parent;
+  auto grandParent = _nodes[parent].parent;
+  auto sibling = _nodes[parent].children[0] == leaf ? _nodes[parent].children[1] : _nodes[parent].children[0];
+
+  _nodes[sibling].parent = grandParent;
+  if (grandParent == NONE)
+    _root = sibling;
+  else if (_nodes[grandParent].children[0] == parent)
+    _nodes[grandParent].children[0] = sibling;
+  else
+    _nodes[grandParent].children[1] = sibling;
+
+  freeNode(parent);
+  _nodes[leaf].parent = NONE;
+
+  refit(grandParent);
+}
+
+void EntityTree::refit(int index)
+{
+  while (index != NONE)
+  {
+    index = balance(index);
+
+    auto& node = _nodes[index];
+    auto& child0 = _nodes[node.children[0]];
+    auto& child1 = _nodes[node.children[1]];
+    node.bounds = child0.bounds.merged(child1.bounds);
+    node.height = 1 + std::max(child0.height, child1.height);
+
+    index = node.parent;
+  }
+}
+
+int EntityTree::balance(int indexA)
+{
+  // if one child is more than one level taller than the other, it's rotated
+  // up into this node's place, taking this node as a child in exchange for
+  // its own taller child
+  auto& a = _nodes[indexA];
+  if (a.leaf() || a.height < 2)
+    return indexA;
+
+  auto difference = _nodes[a.children[1]].height - _nodes[a.children[0]].height;
+  if (difference >= -1 && difference <= 1)
+    return indexA;
+
+  auto upSide = difference > 1 ? 1 : 0;
+  auto indexUp = a.children[upSide];
+  auto& up = _nodes[indexUp];
+  auto& other = _nodes[a.children[1 - upSide]];
+
+  up.parent = a.parent;
+  a.parent = indexUp;
+  if (up.parent == NONE)
+    _root = indexUp;
+  else if (_nodes[up.parent].children[0] == indexA)
+    _nodes[up.parent].children[0] = indexUp;
+  else
+    _nodes[up.parent].children[1] = indexUp;
+
+  // the taller grandchild stays with the node coming up, the shorter one
+  // replaces it under this node
+  auto indexF = up.children[0];
+  auto indexG = up.children[1];
+  if (_nodes[indexF].height > _nodes[indexG].height)
+    std::swap(indexF, indexG);
+
+  up.children[0] = indexA;
+  up.children[1] = indexG;
+  a.children[upSide] = indexF;
+  _nodes[indexF].parent = indexA;
+
+  a.bounds = other.bounds.merged(_nodes[indexF].bounds);
+  a.height = 1 + std::max(other.height, _nodes[indexF].height);
+  up.bounds = a.bounds.merged(_nodes[indexG].bounds);
+  up.height = 1 + std::max(a.height, _nodes[indexG].height);
+
+  return indexUp;
+}
+
+template <class Test>
+void EntityTree::query(Test&& test, std::vector<Entity*>& results) const
+{
+  if (_root == NONE)
+    return;
+
+  std::vector<int> stack{ _root };
+  while (!stack.empty())
+  {
+    auto& node = _nodes[stack.back()];
+    stack.pop_back();
+
+    if (!test(node.bounds))
+      continue;
+
+    if (node.leaf())
+    {
+      if (test(node.exact))
+        results.push_back(node.entity);
+      continue;
+    }
+
+    stack.push_back(node.children[0]);
+    stack.push_back(node.children[1]);
+  }
+}
@@ -0,0 +1,85 @@
+#ifndef WILT_ENTITYTREE_H
+#define WILT_ENTITYTREE_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "../graphics/frustum.h"
+#include "../utilities/bounds.h"
+
+class Entity;
+
+// A dynamic bounding volume tree over the entities' world-space bounds, so
+// culling and "what's near here" questions don't have to look at every
+// entity. Leaves are given some room around the entity, a moving entity is
+// only reinserted once it leaves that room, and the tree is kept balanced by
+// rotating nodes as leaves are inserted and removed.
+class EntityTree
+{
+public:
+  struct RayHit
+  {
+    Entity* entity; // nullptr if nothing was hit
+    float distance;
+  };
+
+private:
+  struct Node
+  {
+    Bounds bounds;   // with room to move for leaves
+    Bounds exact;    // the entity's bounds, leaves only
+    Entity* entity;  // nullptr for branches
+    int parent;      // the next free node while unused
+    int children[2];
+    int height;      // 0 for leaves, -1 while unused
+
+    bool leaf() const { return children[0] == NONE; }
+  };
+
+private:
+  std::vector<Node> _nodes;
+  int _root;
+  int _free;
+
+public:
+  EntityTree();
+
+public:
+  // adds the entity the first time, and after that moves its leaf if it has
+  // left the room it was given
+  void update(Entity* entity);
+  void remove(Entity* entity);
+
+  // each appends to the results rather than clearing them
+  void queryFrustum(const Frustum& frustum, std::vector<Entity*>& results) const;
+  void querySphere(const glm::vec3& center, float radius, std::vector<Entity*>& results) const;
+  void queryBounds(const Bounds& bounds, std::vector<Entity*>& results) const;
+
+  // the closest entity whose bounds the ray passes through, the direction
+  // doesn't need to be normalized but the distance is in its units
+  RayHit raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const;
+
+  int height() const;
+
+private:
+  int allocateNode();
+  void freeNode(int node);
+
+  void insertLeaf(int leaf);
+  void removeLeaf(int leaf);
+  void refit(int node);
+  int balance(int node);
+
+  template <class Test>
+  void query(Test&& test, std::vector<Entity*>& results) const;
+
+public:
+  static const int NONE = -1;
+
+  // how far leaves extend past the entity's bounds on every side
+  static constexpr float MARGIN = 0.5f;
+
+}; // class EntityTree
+
+#endif // !WILT_ENTITYTREE_H
@@ -235,7 +235,7 @@ void doPlayerDeformation(Entity* player, btCollisionWorld* world, btBvhTriangleM
     player->position.y,
     player->position.z);
 
-  const auto POINT_COUNT = playerModel.vertexData.size() / Model::DATA_COUNT_PER_VERTEX;
+  const auto POINT_COUNT = playerModel.vertices().size() / Model::DATA_COUNT_PER_VERTEX;
   const auto POINT_DISTANCE_MAX = 2.0f;
   const auto POINT_WORLD_MARGIN = 0.0625f;
 
@@ -327,7 +327,8 @@ void doPlayerDeformation(Entity* player, btCollisionWorld* world, btBvhTriangleM
     return closestFraction;
   };
 
-  auto newVertexData = playerModel.vertexData;
+  auto vertexData = playerModel.vertices();
+  auto newVertexData = std::vector<float>(vertexData.begin(), vertexData.end());
   for (std::size_t i = 0; i < newVertexData.size(); i += Model::DATA_COUNT_PER_VERTEX)
   {
     // should be a unit vector
@@ -380,7 +381,5 @@ void doPlayerDeformation(Entity* player, btCollisionWorld* world, btBvhTriangleM
     newVertexData[i + 2] *= amount;
   }
 
-  glBindVertexArray(playerModel.vertexDataVAO);
-  glBindBuffer(GL_ARRAY_BUFFER, playerModel.vertexDataVBO);
-  glBufferSubData(GL_ARRAY_BUFFER, 0, newVertexData.size() * sizeof(float), newVertexData.data());
+  playerModel.updateVertices(newVertexData);
 }
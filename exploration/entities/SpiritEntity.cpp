@@ -37,7 +37,10 @@ SpiritEntity::SpiritEntity(Model* model, const EntitySpawnInfo& info)
   , tailPosition1{ position + glm::rotateZ(glm::vec3(-1, 0, 0), rotation.z) * SPIRIT_TAIL_DISTANCE_1 } // make this use rotation.y
   , tailPosition2{ tailPosition1 + glm::rotateZ(glm::vec3(-1, 0, 0), rotation.z) * SPIRIT_TAIL_DISTANCE_2 } // make this use rotation.y
   , tailPosition3{ tailPosition2 + glm::rotateZ(glm::vec3(-1, 0, 0), rotation.z) * SPIRIT_TAIL_DISTANCE_3 } // make this use rotation.y
+  , tailTransformSlots{ EntityTransforms::shared.add(), EntityTransforms::shared.add(), EntityTransforms::shared.add() }
 {
+  updateTransforms();
+
   static std::random_device rd;
   static std::mt19937 gen(rd());
 
@@ -52,6 +55,12 @@ SpiritEntity::SpiritEntity(Model* model, const EntitySpawnInfo& info)
   distance     = (float)dis2(gen) * 2.5f;
 }
 
+SpiritEntity::~SpiritEntity()
+{
+  for (auto slot : tailTransformSlots)
+    EntityTransforms::shared.remove(slot);
+}
+
 void SpiritEntity::update(GameState& state, float time)
 {
   glm::vec3 desiredPosition;
@@ -217,27 +226,38 @@ void SpiritEntity::update(GameState& state, float time)
   }
 }
 
+void SpiritEntity::updateTransforms()
+{
+  Entity::updateTransforms();
+  EntityTransforms::shared.update(tailTransformSlots[0], tailPosition1, {}, scale * SPIRIT_TAIL_SIZE_1);
+  EntityTransforms::shared.update(tailTransformSlots[1], tailPosition2, {}, scale * SPIRIT_TAIL_SIZE_2);
+  EntityTransforms::shared.update(tailTransformSlots[2], tailPosition3, {}, scale * SPIRIT_TAIL_SIZE_3);
+}
+
+Bounds SpiritEntity::bounds() const
+{
+  auto bounds = Entity::bounds();
+  for (auto slot : tailTransformSlots)
+    bounds = bounds.merged(model->bounds.transformed(EntityTransforms::shared[slot] * model->transform));
+  return bounds;
+}
 
 void SpiritEntity::draw_faces(GameState& state, DepthProgram& program, float time)
 {
-  std::array<glm::mat4, MAX_JOINTS> jointTransforms;
-  program.setPositions(jointTransforms);
+  program.setSkinned(false);
   program.setDrawPercentage(1.0f);
-  model->draw_faces(program, time, model->makeEntityTransform(position, rotation, scale));
-  model->draw_faces(program, time, model->makeEntityTransform(tailPosition1, {}, scale * SPIRIT_TAIL_SIZE_1));
-  model->draw_faces(program, time, model->makeEntityTransform(tailPosition2, {}, scale * SPIRIT_TAIL_SIZE_2));
-  model->draw_faces(program, time, model->makeEntityTransform(tailPosition3, {}, scale * SPIRIT_TAIL_SIZE_3));
+  model->draw_faces(program, time, transform());
+  for (auto slot : tailTransformSlots)
+    model->draw_faces(program, time, EntityTransforms::shared[slot]);
 }
 
 void SpiritEntity::draw_lines(GameState& state, LineProgram& program, float time)
 {
-  std::array<glm::mat4, MAX_JOINTS> jointTransforms;
-  program.setPositions(jointTransforms);
+  program.setSkinned(false);
   program.setDrawPercentage(1.0f);
-  model->draw_lines(program, time, model->makeEntityTransform(position, rotation, scale));
-  model->draw_lines(program, time, model->makeEntityTransform(tailPosition1, {}, scale * SPIRIT_TAIL_SIZE_1));
-  model->draw_lines(program, time, model->makeEntityTransform(tailPosition2, {}, scale * SPIRIT_TAIL_SIZE_2));
-  model->draw_lines(program, time, model->makeEntityTransform(tailPosition3, {}, scale * SPIRIT_TAIL_SIZE_3));
+  model->draw_lines(program, time, transform());
+  for (auto slot : tailTransformSlots)
+    model->draw_lines(program, time, EntityTransforms::shared[slot]);
 }
 
 void SpiritEntity::draw_debug(GameState& state, DebugProgram& program, float time)
@@ -33,6 +33,7 @@ public:
   glm::vec3 tailPosition1;
   glm::vec3 tailPosition2;
   glm::vec3 tailPosition3;
+  std::size_t tailTransformSlots[3];
 
   // IDLE
   float heightMax;
@@ -50,10 +51,13 @@ public:
 
 public:
   SpiritEntity(Model* model, const EntitySpawnInfo& info);
+  ~SpiritEntity() override;
 
 public:
   // Entity overrides
   void update(GameState& state, float time) override;
+  void updateTransforms() override;
+  Bounds bounds() const override;
 
   void draw_faces(GameState& state, DepthProgram& program, float time) override;
   void draw_lines(GameState& state, LineProgram& program, float time) override;
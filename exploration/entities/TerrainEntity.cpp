@@ -1,10 +1,197 @@
 #include "TerrainEntity.h"
 
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include "../logging/LoggingManager.h"
+namespace { auto logger = wilt::logging.createLogger("entities-terrain"); }
+
+namespace
+{
+  // Building the quantized BVH is the slow part of creating a terrain shape,
+  // so it's built once per mesh and kept, both in memory for respawns and in
+  // cache/<key>.bvh for later runs. The key hashes the triangles the shape is
+  // built from along with the Bullet build details that affect the
+  // serialized layout, so edited models or a different Bullet just miss.
+  const char BVH_MAGIC[4] = { 'W', 'O', 'W', 'B' };
+  const std::filesystem::path BVH_CACHE_DIRECTORY = "cache";
+
+  struct BvhCacheHeader
+  {
+    char magic[4];
+    std::uint32_t bytes;
+    std::uint64_t key;
+  };
+
+  std::map<std::uint64_t, btOptimizedBvh*> loadedBvhs;
+
+  // FNV-1a
+  std::uint64_t hash(std::uint64_t seed, const void* data, std::size_t bytes)
+  {
+    auto hashed = seed;
+    for (std::size_t i = 0; i < bytes; ++i)
+    {
+      hashed ^= ((const unsigned char*)data)[i];
+      hashed *= 0x100000001b3ull;
+    }
+
+    return hashed;
+  }
+
+  std::uint64_t hashTerrain(ArrayView<const float> vertices, ArrayView<const unsigned int> faces)
+  {
+    const std::uint32_t build[] = { BT_BULLET_VERSION, sizeof(btScalar), sizeof(void*) };
+
+    auto hashed = hash(0xcbf29ce484222325ull, build, sizeof(build));
+    for (std::size_t i = 0; i + 2 < vertices.size(); i += Model::DATA_COUNT_PER_VERTEX)
+      hashed = hash(hashed, &vertices[i], 3 * sizeof(float)); // only the position is used
+    hashed = hash(hashed, faces.data(), faces.bytes());
+
+    return hashed;
+  }
+
+  std::filesystem::path bvhCacheFilename(std::uint64_t key)
+  {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bvh", (unsigned long long)key);
+    return BVH_CACHE_DIRECTORY / name;
+  }
+
+  // the buffer the BVH is deserialized into backs it from then on, so it is
+  // kept for as long as the shapes are (which is forever)
+  btOptimizedBvh* readBvh(std::uint64_t key)
+  {
+    auto filename = bvhCacheFilename(key);
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+      return nullptr;
+
+    BvhCacheHeader header;
+    file.read((char*)&header, sizeof(header));
+    auto error = std::error_code();
+    auto fileSize = std::filesystem::file_size(filename, error);
+    if (!file || std::memcmp(header.magic, BVH_MAGIC, sizeof(BVH_MAGIC)) != 0 || header.key != key || error || fileSize != sizeof(header) + header.bytes)
+    {
+      logger.warn("ignoring bad cache file: " + filename.string());
+      return nullptr;
+    }
+
+    auto buffer = btAlignedAlloc(header.bytes, 16);
+    file.read((char*)buffer, header.bytes);
+    auto bvh = file ? btOptimizedBvh::deSerializeInPlace(buffer, header.bytes, false) : nullptr;
+    if (bvh == nullptr)
+    {
+      logger.warn("ignoring bad cache file: " + filename.string());
+      btAlignedFree(buffer);
+      return nullptr;
+    }
+
+    return bvh;
+  }
+
+  void writeBvh(std::uint64_t key, const btOptimizedBvh& bvh)
+  {
+    BvhCacheHeader header;
+    std::memcpy(header.magic, BVH_MAGIC, sizeof(BVH_MAGIC));
+    header.bytes = bvh.calculateSerializeBufferSize();
+    header.key = key;
+
+    auto buffer = btAlignedAlloc(header.bytes, 16);
+    bvh.serializeInPlace(buffer, header.bytes, false);
+
+    // written next to the target and moved over it so a run that stops part
+    // way never leaves a truncated file behind
+    auto error = std::error_code();
+    auto filename = bvhCacheFilename(key);
+    auto temporaryFilename = filename;
+    temporaryFilename += ".tmp";
+
+    std::filesystem::create_directories(BVH_CACHE_DIRECTORY, error);
+    std::ofstream file(temporaryFilename, std::ios::binary | std::ios::trunc);
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)buffer, header.bytes);
+    file.close();
+    btAlignedFree(buffer);
+
+    if (!file)
+    {
+      logger.warn("writing cache file: " + temporaryFilename.string());
+      std::filesystem::remove(temporaryFilename, error);
+      return;
+    }
+
+    std::filesystem::rename(temporaryFilename, filename, error);
+    if (error)
+    {
+      logger.warn("replacing cache file: " + filename.string());
+      std::filesystem::remove(temporaryFilename, error);
+    }
+  }
+
+  // the model's vertex data is freed (or unmapped) when it's hot reloaded, so
+  // the mesh keeps its own copy of the positions and faces the shape reads
+  struct TerrainMeshData
+  {
+    std::vector<float> positions;
+    std::vector<int> indexes;
+
+    TerrainMeshData(ArrayView<const float> vertices, ArrayView<const unsigned int> faces)
+      : positions{ }
+      , indexes{ faces.begin(), faces.end() }
+    {
+      positions.reserve(vertices.size() / Model::DATA_COUNT_PER_VERTEX * 3);
+      for (std::size_t i = 0; i + 2 < vertices.size(); i += Model::DATA_COUNT_PER_VERTEX)
+        positions.insert(positions.end(), &vertices[i], &vertices[i] + 3);
+    }
+  };
+
+  // the data is a base rather than a member so it's filled before the array
+  // that points into it is constructed
+  class TerrainMesh : private TerrainMeshData, public btTriangleIndexVertexArray
+  {
+  public:
+    TerrainMesh(ArrayView<const float> vertices, ArrayView<const unsigned int> faces)
+      : TerrainMeshData{ vertices, faces }
+      , btTriangleIndexVertexArray{ (int)(indexes.size() / 3), indexes.data(), 3 * sizeof(int), (int)(positions.size() / 3), positions.data(), 3 * sizeof(float) }
+    { }
+  }; // class TerrainMesh
+
+  btBvhTriangleMeshShape* createTerrainShape(btStridingMeshInterface* mesh, std::uint64_t key)
+  {
+    auto loaded = loadedBvhs.find(key);
+    if (loaded == loadedBvhs.end())
+    {
+      auto bvh = readBvh(key);
+      if (bvh != nullptr)
+        loaded = loadedBvhs.emplace(key, bvh).first;
+    }
+
+    if (loaded != loadedBvhs.end())
+    {
+      auto shape = new btBvhTriangleMeshShape(mesh, true, false);
+      shape->setOptimizedBvh(loaded->second);
+      return shape;
+    }
+
+    auto shape = new btBvhTriangleMeshShape(mesh, true, true);
+    loadedBvhs.emplace(key, shape->getOptimizedBvh());
+    writeBvh(key, *shape->getOptimizedBvh());
+    return shape;
+  }
+}
+
 btRigidBody* createTerrainBody(Model* model)
 {
   // TODO: move shape creation to model, though... this will almost always be created once anyways...
-  auto terrainMesh = new btTriangleIndexVertexArray(model->faceIndexes.size() / 3, (int*)model->faceIndexes.data(), 3 * sizeof(int), model->vertexData.size() / Model::DATA_COUNT_PER_VERTEX, model->vertexData.data(), Model::DATA_COUNT_PER_VERTEX * sizeof(float));
-  auto terrainShape = new btBvhTriangleMeshShape(terrainMesh, true);
+  auto vertices = model->vertices();
+  auto faces = model->faces();
+  auto terrainMesh = new TerrainMesh(vertices, faces);
+  auto terrainShape = createTerrainShape(terrainMesh, hashTerrain(vertices, faces));
   terrainShape->setMargin(0.0f);
 
   auto terrainMotionState = new btDefaultMotionState();
@@ -1,15 +1,16 @@
 #ifndef WILT_IANIMATOR_H
 #define WILT_IANIMATOR_H
 
-#include <vector>
+#include <glm/glm.hpp>
 
-#include "program.h"
-#include "joint.h"
+#include "skeleton.h"
 
 class IAnimator
 {
 public:
-  virtual void applyAnimation(Program& program, float time, std::vector<Joint>& joints) = 0;
+  // writes one transform per joint of the skeleton into transforms, entities
+  // sharing an animator may call this from several threads at once
+  virtual void applyAnimation(float time, const Skeleton& skeleton, glm::mat4* transforms) = 0;
 
 }; // class IAnimator
 
@@ -0,0 +1,151 @@
+#include "bufferArena.h"
+
+#include <algorithm>
+
+namespace
+{
+  const std::size_t MINIMUM_CAPACITY = 1 << 20;
+
+  std::size_t alignUp(std::size_t offset, std::size_t alignment)
+  {
+    return (offset + alignment - 1) / alignment * alignment;
+  }
+}
+
+BufferArena::BufferArena()
+  : _id{ 0 }
+  , _capacity{ 0 }
+  , _free{ }
+{ }
+
+BufferArena::BufferArena(BufferArena&& s)
+  : _id{ s._id }
+  , _capacity{ s._capacity }
+  , _free{ std::move(s._free) }
+{
+  s._id = 0;
+  s._capacity = 0;
+  s._free.clear();
+}
+
+BufferArena& BufferArena::operator= (BufferArena&& s)
+{
+  release();
+
+  _id = s._id;
+  _capacity = s._capacity;
+  _free = std::move(s._free);
+  s._id = 0;
+  s._capacity = 0;
+  s._free.clear();
+
+  return *this;
+}
+
+BufferArena::~BufferArena()
+{
+  release();
+}
+
+GLuint BufferArena::id() const
+{
+  return _id;
+}
+
+std::size_t BufferArena::capacity() const
+{
+  return _capacity;
+}
+
+void BufferArena::release()
+{
+  if (_id != 0)
+    glDeleteBuffers(1, &_id);
+
+  _id = 0;
+  _capacity = 0;
+  _free.clear();
+}
+
+bool BufferArena::loaded() const
+{
+  return _id != 0;
+}
+
+std::size_t BufferArena::allocate(std::size_t bytes, std::size_t alignment)
+{
+  if (bytes == 0)
+    return 0;
+
+  while (true)
+  {
+    for (auto block = _free.begin(); block != _free.end(); ++block)
+    {
+      auto [blockOffset, blockBytes] = *block;
+      auto offset = alignUp(blockOffset, alignment);
+      if (offset + bytes > blockOffset + blockBytes)
+        continue;
+
+      // keep whatever is left on either side
+      _free.erase(block);
+      if (offset > blockOffset)
+        _free[blockOffset] = offset - blockOffset;
+      if (offset + bytes < blockOffset + blockBytes)
+        _free[offset + bytes] = blockOffset + blockBytes - (offset + bytes);
+
+      return offset;
+    }
+
+    grow(bytes + alignment);
+  }
+}
+
+void BufferArena::free(std::size_t offset, std::size_t bytes)
+{
+  if (bytes == 0)
+    return;
+
+  auto block = _free.emplace(offset, bytes).first;
+
+  auto next = std::next(block);
+  if (next != _free.end() && block->first + block->second == next->first)
+  {
+    block->second += next->second;
+    _free.erase(next);
+  }
+
+  if (block != _free.begin())
+  {
+    auto previous = std::prev(block);
+    if (previous->first + previous->second == block->first)
+    {
+      previous->second += block->second;
+      _free.erase(block);
+    }
+  }
+}
+
+void BufferArena::write(std::size_t offset, const void* data, std::size_t bytes)
+{
+  if (bytes > 0)
+    glNamedBufferSubData(_id, (GLintptr)offset, (GLsizeiptr)bytes, data);
+}
+
+void BufferArena::grow(std::size_t bytes)
+{
+  auto capacity = std::max({ MINIMUM_CAPACITY, _capacity * 2, _capacity + bytes });
+
+  GLuint id;
+  glCreateBuffers(1, &id);
+  glNamedBufferData(id, (GLsizeiptr)capacity, nullptr, GL_STATIC_DRAW);
+  if (_id != 0)
+  {
+    glCopyNamedBufferSubData(_id, id, 0, 0, (GLsizeiptr)_capacity);
+    glDeleteBuffers(1, &_id);
+  }
+
+  auto oldCapacity = _capacity;
+  _id = id;
+  _capacity = capacity;
+  free(oldCapacity, capacity - oldCapacity);
+}
@@ -0,0 +1,48 @@
+#ifndef WILT_BUFFERARENA_H
+#define WILT_BUFFERARENA_H
+
+#include <cstddef>
+#include <map>
+
+#include <glad/glad.h>
+
+// A single GL buffer that ranges are carved out of (first fit, with freed
+// ranges merged back together). When nothing fits the buffer is replaced by
+// one twice the size and the contents copied over, so id() can change after
+// allocate().
+class BufferArena
+{
+private:
+  GLuint _id;
+  std::size_t _capacity;
+  std::map<std::size_t, std::size_t> _free; // offset -> bytes
+
+public:
+  BufferArena();
+  BufferArena(const BufferArena& s) = delete;
+  BufferArena(BufferArena&& s);
+
+  BufferArena& operator= (const BufferArena& s) = delete;
+  BufferArena& operator= (BufferArena&& s);
+
+  ~BufferArena();
+
+public:
+  GLuint id() const;
+  std::size_t capacity() const;
+  void release();
+  bool loaded() const;
+
+public:
+  // the alignment needn't be a power of two, vertex ranges are aligned to
+  // their stride so the offset is a whole number of vertices
+  std::size_t allocate(std::size_t bytes, std::size_t alignment);
+  void free(std::size_t offset, std::size_t bytes);
+  void write(std::size_t offset, const void* data, std::size_t bytes);
+
+private:
+  void grow(std::size_t bytes);
+
+}; // class BufferArena
+
+#endif // !WILT_BUFFERARENA_H
@@ -0,0 +1,68 @@
+#include "debugOutput.h"
+
+#include <string>
+
+#include <glad/glad.h>
+
+#include "../logging/LoggingManager.h"
+namespace { auto logger = wilt::logging.createLogger("graphics-debug"); }
+
+namespace
+{
+  const char* sourceName(GLenum source)
+  {
+    switch (source)
+    {
+    case GL_DEBUG_SOURCE_API:             return "api";
+    case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   return "window system";
+    case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+    case GL_DEBUG_SOURCE_THIRD_PARTY:     return "third party";
+    case GL_DEBUG_SOURCE_APPLICATION:     return "application";
+    default:                              return "other";
+    }
+  }
+
+  const char* typeName(GLenum type)
+  {
+    switch (type)
+    {
+    case GL_DEBUG_TYPE_ERROR:               return "error";
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated behavior";
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "undefined behavior";
+    case GL_DEBUG_TYPE_PORTABILITY:         return "portability";
+    case GL_DEBUG_TYPE_PERFORMANCE:         return "performance";
+    default:                                return "other";
+    }
+  }
+
+  void APIENTRY logMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* /*userParam*/)
+  {
+    auto text = std::string(sourceName(source)) + " " + typeName(type) + " " + std::to_string(id) + ": " + (length >= 0 ? std::string(message, length) : std::string(message));
+
+    switch (severity)
+    {
+    case GL_DEBUG_SEVERITY_HIGH:   logger.error(text); break;
+    case GL_DEBUG_SEVERITY_MEDIUM: logger.warn(text);  break;
+    case GL_DEBUG_SEVERITY_LOW:    logger.info(text);  break;
+    default:                       logger.debug(text); break;
+    }
+  }
+}
+
+bool enableDebugOutput()
+{
+  if (glDebugMessageCallback == nullptr)
+  {
+    logger.warn("debug output is not supported");
+    return false;
+  }
+
+  glEnable(GL_DEBUG_OUTPUT);
+  glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+  glDebugMessageCallback(logMessage, nullptr);
+
+  // notifications are mostly drivers describing buffer placement
+  glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+
+  return true;
+}
@@ -0,0 +1,10 @@
+#ifndef WILT_DEBUGOUTPUT_H
+#define WILT_DEBUGOUTPUT_H
+
+// Routes the driver's debug messages (KHR_debug, core since 4.3) to the log.
+// Messages are delivered synchronously so they are logged during the call
+// that caused them, which costs performance, so it's only turned on when
+// asked for. Returns false if the context doesn't support it.
+bool enableDebugOutput();
+
+#endif // !WILT_DEBUGOUTPUT_H
@@ -0,0 +1,251 @@
+#include "depthPyramid.h"
+
+#include <algorithm>
+
+namespace
+{
+  // the next level down, where the last row and column also cover the extra
+  // texel of an odd sized level (the same as pyramid.comp.glsl)
+  void reduce(const std::vector<float>& source, GLsizei sourceWidth, GLsizei sourceHeight, std::vector<float>& destination, GLsizei width, GLsizei height)
+  {
+    destination.resize(width * height);
+    for (GLsizei y = 0; y < height; ++y)
+    {
+      auto firstY = y * 2;
+      auto lastY = std::min(firstY + 1 + (y == height - 1 ? sourceHeight & 1 : 0), sourceHeight - 1);
+      for (GLsizei x = 0; x < width; ++x)
+      {
+        auto firstX = x * 2;
+        auto lastX = std::min(firstX + 1 + (x == width - 1 ? sourceWidth & 1 : 0), sourceWidth - 1);
+
+        auto depth = 0.0f;
+        for (auto sy = firstY; sy <= lastY; ++sy)
+          for (auto sx = firstX; sx <= lastX; ++sx)
+            depth = std::max(depth, source[sy * sourceWidth + sx]);
+
+        destination[y * width + x] = depth;
+      }
+    }
+  }
+}
+
+DepthPyramid::DepthPyramid(Shader computeShader)
+  : _program{ std::move(computeShader) }
+  , _texture{ 0 }
+  , _width{ 0 }
+  , _height{ 0 }
+  , _sizes{ }
+  , _readBuffers{ 0, 0 }
+  , _fences{ nullptr, nullptr }
+  , _readViewProjections{ }
+  , _next{ 0 }
+  , _levels{ }
+  , _viewProjection{ }
+{ }
+
+DepthPyramid::~DepthPyramid()
+{
+  release();
+}
+
+void DepthPyramid::release()
+{
+  for (auto& fence : _fences)
+  {
+    if (fence)
+      glDeleteSync(fence);
+    fence = nullptr;
+  }
+
+  if (_readBuffers[0] != 0)
+    glDeleteBuffers(2, _readBuffers);
+  if (_texture != 0)
+    glDeleteTextures(1, &_texture);
+
+  _readBuffers[0] = 0;
+  _readBuffers[1] = 0;
+  _texture = 0;
+  _width = 0;
+  _height = 0;
+  _sizes.clear();
+  _levels.clear();
+}
+
+bool DepthPyramid::loaded() const
+{
+  return _texture != 0;
+}
+
+void DepthPyramid::build(const Texture& depthTexture, GLsizei width, GLsizei height, const glm::mat4& viewProjection)
+{
+  if (_program.id() == 0 || width <= 0 || height <= 0)
+    return;
+
+  if (width != _width || height != _height)
+    createTexture(width, height);
+
+  collect();
+
+  _program.use();
+
+  for (std::size_t level = 0; level < _sizes.size(); ++level)
+  {
+    glBindImageTexture(0, _texture, (GLint)level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    if (level == 0)
+      glBindImageTexture(1, depthTexture.id(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+    else
+      glBindImageTexture(1, _texture, (GLint)level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+
+    glDispatchCompute((_sizes[level].x + 7) / 8, (_sizes[level].y + 7) / 8, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+  }
+
+  // a read back that still hasn't finished by now is dropped for this one
+  auto& size = _sizes.back();
+  auto bytes = (GLsizei)(size.x * size.y * sizeof(float));
+  if (_fences[_next])
+    glDeleteSync(_fences[_next]);
+
+  glMemoryBarrier(GL_TEXTURE_UPDATE_BARRIER_BIT);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, _readBuffers[_next]);
+  glGetTextureImage(_texture, (GLint)_sizes.size() - 1, GL_RED, GL_FLOAT, bytes, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  _fences[_next] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  _readViewProjections[_next] = viewProjection;
+  _next = 1 - _next;
+}
+
+bool DepthPyramid::occluded(const Bounds& bounds) const
+{
+  if (_levels.empty())
+    return false;
+
+  // the box's extent on screen and its nearest depth, boxes reaching behind
+  // the camera are always visible
+  auto ndcMin = glm::vec3(1.0f);
+  auto ndcMax = glm::vec3(-1.0f);
+  for (int i = 0; i < 8; ++i)
+  {
+    auto corner = glm::vec3(
+      i & 1 ? bounds.max.x : bounds.min.x,
+      i & 2 ? bounds.max.y : bounds.min.y,
+      i & 4 ? bounds.max.z : bounds.min.z);
+
+    auto clip = _viewProjection * glm::vec4(corner, 1.0f);
+    if (clip.w <= 0.0f)
+      return false;
+
+    auto ndc = glm::vec3(clip) / clip.w;
+    ndcMin = i == 0 ? ndc : glm::min(ndcMin, ndc);
+    ndcMax = i == 0 ? ndc : glm::max(ndcMax, ndc);
+  }
+
+  if (ndcMin.z < -1.0f)
+    return false;
+
+  auto nearest = ndcMin.z * 0.5f + 0.5f;
+
+  // the covered pixels, then the texels that cover them in the coarsest level
+  // the read back came from; the first GPU level is already half size
+  auto pixel = [](float ndc, GLsizei size) { return std::clamp((GLsizei)((ndc * 0.5f + 0.5f) * size), 0, size - 1); };
+  auto shift = (int)_sizes.size();
+  auto x0 = pixel(ndcMin.x, _width) >> shift;
+  auto x1 = pixel(ndcMax.x, _width) >> shift;
+  auto y0 = pixel(ndcMin.y, _height) >> shift;
+  auto y1 = pixel(ndcMax.y, _height) >> shift;
+
+  // down the levels until the box covers at most four by four texels, any
+  // coarser and the texels on its edges reach too far past it
+  std::size_t level = 0;
+  while (true)
+  {
+    auto& current = _levels[level];
+    x0 = std::min(x0, current.width - 1);
+    x1 = std::min(x1, current.width - 1);
+    y0 = std::min(y0, current.height - 1);
+    y1 = std::min(y1, current.height - 1);
+
+    if ((x1 - x0 <= 3 && y1 - y0 <= 3) || level + 1 == _levels.size())
+      break;
+
+    x0 >>= 1;
+    x1 >>= 1;
+    y0 >>= 1;
+    y1 >>= 1;
+    level += 1;
+  }
+
+  auto& current = _levels[level];
+  auto furthest = 0.0f;
+  for (auto y = y0; y <= y1; ++y)
+    for (auto x = x0; x <= x1; ++x)
+      furthest = std::max(furthest, current.depths[y * current.width + x]);
+
+  return nearest > furthest;
+}
+
+void DepthPyramid::createTexture(GLsizei width, GLsizei height)
+{
+  release();
+
+  _width = width;
+  _height = height;
+
+  auto size = glm::ivec2(std::max(width / 2, 1), std::max(height / 2, 1));
+  _sizes.push_back(size);
+  while (size.x > READBACK_WIDTH && (size.x > 1 || size.y > 1))
+  {
+    size = glm::max(size / 2, glm::ivec2(1));
+    _sizes.push_back(size);
+  }
+
+  glCreateTextures(GL_TEXTURE_2D, 1, &_texture);
+  glTextureStorage2D(_texture, (GLsizei)_sizes.size(), GL_R32F, _sizes[0].x, _sizes[0].y);
+
+  glCreateBuffers(2, _readBuffers);
+  for (auto buffer : _readBuffers)
+    glNamedBufferData(buffer, size.x * size.y * sizeof(float), nullptr, GL_STREAM_READ);
+}
+
+void DepthPyramid::collect()
+{
+  // the newest finished read back wins, and anything older goes with it
+  auto ready = [](GLsync fence)
+  {
+    if (!fence)
+      return false;
+    auto status = glClientWaitSync(fence, 0, 0);
+    return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+  };
+
+  auto newest = 1 - _next;
+  auto slot = ready(_fences[newest]) ? newest : ready(_fences[_next]) ? _next : -1;
+  if (slot == -1)
+    return;
+
+  auto& size = _sizes.back();
+  _levels.resize(1);
+  _levels[0].width = size.x;
+  _levels[0].height = size.y;
+  _levels[0].depths.resize(size.x * size.y);
+  glGetNamedBufferSubData(_readBuffers[slot], 0, size.x * size.y * sizeof(float), _levels[0].depths.data());
+  _viewProjection = _readViewProjections[slot];
+
+  while (_levels.back().width > 1 || _levels.back().height > 1)
+  {
+    auto& source = _levels.back();
+    auto next = Level{ std::max(source.width / 2, 1), std::max(source.height / 2, 1), {} };
+    reduce(source.depths, source.width, source.height, next.depths, next.width, next.height);
+    _levels.push_back(std::move(next));
+  }
+
+  for (auto finished : { slot, slot == newest ? _next : -1 })
+  {
+    if (finished != -1 && _fences[finished])
+    {
+      glDeleteSync(_fences[finished]);
+      _fences[finished] = nullptr;
+    }
+  }
+}
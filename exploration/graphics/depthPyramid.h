@@ -0,0 +1,80 @@
+#ifndef WILT_DEPTHPYRAMID_H
+#define WILT_DEPTHPYRAMID_H
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "program.h"
+#include "texture.h"
+#include "../utilities/bounds.h"
+
+// A hierarchical-z pyramid of the face pass' depth, for skipping things that
+// are hidden behind what's already been drawn. Each level holds the furthest
+// depth of the texels below it, so a box whose nearest point is behind that
+// can't be visible anywhere in the area.
+//
+// The finer levels are built on the GPU after the face pass. The coarsest of
+// those is read back without waiting on it, and the levels below it are built
+// here from whichever frame arrived last. Boxes are tested against that
+// frame's depth with that frame's view, so what's hidden can lag a frame
+// behind the camera.
+class DepthPyramid
+{
+private:
+  struct Level
+  {
+    GLsizei width;
+    GLsizei height;
+    std::vector<float> depths;
+  };
+
+private:
+  Program _program;
+  GLuint _texture;
+  GLsizei _width;  // of the depth buffer the texture was made for
+  GLsizei _height;
+  std::vector<glm::ivec2> _sizes; // of the GPU levels
+
+  // read backs in flight, with the view they were drawn with
+  GLuint _readBuffers[2];
+  GLsync _fences[2];
+  glm::mat4 _readViewProjections[2];
+  int _next;
+
+  std::vector<Level> _levels;
+  glm::mat4 _viewProjection;
+
+public:
+  explicit DepthPyramid(Shader computeShader);
+  DepthPyramid(const DepthPyramid& s) = delete;
+
+  DepthPyramid& operator= (const DepthPyramid& s) = delete;
+
+  ~DepthPyramid();
+
+public:
+  void release();
+  bool loaded() const;
+
+public:
+  // builds the pyramid from the resolved depth (see DepthResolve) and starts
+  // reading it back, and picks up an earlier read back if it's finished
+  void build(const Texture& depthTexture, GLsizei width, GLsizei height, const glm::mat4& viewProjection);
+
+  // whether the box is certainly behind the depth, false if there's no depth
+  // yet or the box reaches past the near plane
+  bool occluded(const Bounds& bounds) const;
+
+private:
+  void createTexture(GLsizei width, GLsizei height);
+  void collect();
+
+public:
+  // the GPU builds levels until they're at most this wide
+  static const GLsizei READBACK_WIDTH = 128;
+
+}; // class DepthPyramid
+
+#endif // !WILT_DEPTHPYRAMID_H
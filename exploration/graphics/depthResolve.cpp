@@ -0,0 +1,60 @@
+#include "depthResolve.h"
+
+DepthResolve::DepthResolve(Shader computeShader, int dilation)
+  : _program{ std::move(computeShader) }
+  , _texture{ }
+  , _width{ 0 }
+  , _height{ 0 }
+  , _dilation{ dilation }
+  , _linked{ false }
+{
+  _linked = _program.id() != 0;
+}
+
+void DepthResolve::release()
+{
+  _texture.release();
+  _width = 0;
+  _height = 0;
+}
+
+bool DepthResolve::loaded() const
+{
+  return _linked;
+}
+
+const Texture& DepthResolve::texture() const
+{
+  return _texture;
+}
+
+void DepthResolve::resolve(const Texture& depthTexture, GLsizei width, GLsizei height)
+{
+  if (!_linked || width <= 0 || height <= 0)
+    return;
+
+  // the storage can't change size, so it's remade when the window does
+  if (width != _width || height != _height)
+  {
+    GLuint id;
+    glCreateTextures(GL_TEXTURE_2D, 1, &id);
+    glTextureStorage2D(id, 1, GL_R32F, width, height);
+    glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    _texture = Texture{ id, GL_R32F };
+    _width = width;
+    _height = height;
+  }
+
+  _program.use();
+  _program.setInt("depth_texture", 0);
+  _program.setInt("dilation", _dilation);
+  glBindTextureUnit(0, depthTexture.id());
+  glBindImageTexture(0, _texture.id(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+  glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+
+  // read as an image by the depth pyramid and fetched by the line pass
+  glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
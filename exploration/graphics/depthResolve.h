@@ -0,0 +1,40 @@
+#ifndef WILT_DEPTHRESOLVE_H
+#define WILT_DEPTHRESOLVE_H
+
+#include <glad/glad.h>
+
+#include "program.h"
+#include "texture.h"
+
+// The face pass' multisampled depth resolved to a single sample per pixel,
+// keeping the furthest of each pixel's samples and of its neighbours' out to
+// the dilation. Testing against the furthest depth means a line is only
+// hidden if every sample nearby would hide it.
+class DepthResolve
+{
+private:
+  Program _program;
+  Texture _texture; // GL_R32F
+  GLsizei _width;
+  GLsizei _height;
+  int _dilation;
+  bool _linked;
+
+public:
+  explicit DepthResolve(Shader computeShader, int dilation = 1);
+  DepthResolve(const DepthResolve& s) = delete;
+
+  DepthResolve& operator= (const DepthResolve& s) = delete;
+
+public:
+  void release();
+  bool loaded() const;
+
+public:
+  const Texture& texture() const;
+
+  void resolve(const Texture& depthTexture, GLsizei width, GLsizei height);
+
+}; // class DepthResolve
+
+#endif // !WILT_DEPTHRESOLVE_H
@@ -0,0 +1,67 @@
+#include "frameUniforms.h"
+
+#include <cstddef>
+
+namespace
+{
+  static_assert(offsetof(FrameUniforms, viewReference) == 256, "FrameUniforms must match the std140 layout");
+  static_assert(offsetof(FrameUniforms, cameraPosition) == 272, "FrameUniforms must match the std140 layout");
+  static_assert(offsetof(FrameUniforms, baseCameraDirection) == 288, "FrameUniforms must match the std140 layout");
+  static_assert(sizeof(FrameUniforms) == 304, "FrameUniforms must match the std140 layout");
+}
+
+FrameUniformBuffer::FrameUniformBuffer()
+  : _id{ 0 }
+{ }
+
+FrameUniformBuffer::FrameUniformBuffer(FrameUniformBuffer&& s)
+  : _id{ s._id }
+{
+  s._id = 0;
+}
+
+FrameUniformBuffer& FrameUniformBuffer::operator= (FrameUniformBuffer&& s)
+{
+  release();
+
+  _id = s._id;
+  s._id = 0;
+
+  return *this;
+}
+
+FrameUniformBuffer::~FrameUniformBuffer()
+{
+  release();
+}
+
+GLuint FrameUniformBuffer::id()
+{
+  return _id;
+}
+
+void FrameUniformBuffer::release()
+{
+  if (_id != 0)
+  {
+    glDeleteBuffers(1, &_id);
+    _id = 0;
+  }
+}
+
+bool FrameUniformBuffer::loaded() const
+{
+  return _id != 0;
+}
+
+void FrameUniformBuffer::update(const FrameUniforms& uniforms)
+{
+  if (_id == 0)
+  {
+    glCreateBuffers(1, &_id);
+    glNamedBufferData(_id, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, _id);
+  }
+
+  glNamedBufferSubData(_id, 0, sizeof(FrameUniforms), &uniforms);
+}
@@ -0,0 +1,54 @@
+#ifndef WILT_FRAMEUNIFORMS_H
+#define WILT_FRAMEUNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Matches the std140 "Frame" uniform block in shaders/frame.glsl, which the
+// shaders include. The vec3s are each followed by a float so nothing needs
+// padding.
+struct FrameUniforms
+{
+  glm::mat4 projection;
+  glm::mat4 view;
+  glm::mat4 referenceProjection;
+  glm::mat4 referenceView;
+  glm::vec3 viewReference;
+  float ratio;
+  glm::vec3 cameraPosition;
+  float viewportWidth;
+  glm::vec3 baseCameraDirection;
+  float viewportHeight;
+};
+
+// The buffer behind the "Frame" block, written once a frame and bound to
+// BINDING where every program finds it.
+class FrameUniformBuffer
+{
+private:
+  GLuint _id;
+
+public:
+  FrameUniformBuffer();
+  FrameUniformBuffer(const FrameUniformBuffer& s) = delete;
+  FrameUniformBuffer(FrameUniformBuffer&& s);
+
+  FrameUniformBuffer& operator= (const FrameUniformBuffer& s) = delete;
+  FrameUniformBuffer& operator= (FrameUniformBuffer&& s);
+
+  ~FrameUniformBuffer();
+
+public:
+  GLuint id();
+  void release();
+  bool loaded() const;
+
+public:
+  void update(const FrameUniforms& uniforms);
+
+public:
+  static const GLuint BINDING = 0;
+
+}; // class FrameUniformBuffer
+
+#endif // !WILT_FRAMEUNIFORMS_H
@@ -0,0 +1,46 @@
+#include "frustum.h"
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+  // each plane is the last row of the matrix plus or minus one of the others
+  auto row = [&](int i) { return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]); };
+
+  _planes[0] = row(3) + row(0); // left
+  _planes[1] = row(3) - row(0); // right
+  _planes[2] = row(3) + row(1); // bottom
+  _planes[3] = row(3) - row(1); // top
+  _planes[4] = row(3) + row(2); // near
+  _planes[5] = row(3) - row(2); // far
+
+  for (auto& plane : _planes)
+    plane /= glm::length(glm::vec3(plane));
+}
+
+bool Frustum::intersects(const Bounds& bounds) const
+{
+  // the box is outside if its corner furthest along a plane's normal is
+  // still behind it
+  for (auto& plane : _planes)
+  {
+    auto corner = glm::vec3(
+      plane.x >= 0.0f ? bounds.max.x : bounds.min.x,
+      plane.y >= 0.0f ? bounds.max.y : bounds.min.y,
+      plane.z >= 0.0f ? bounds.max.z : bounds.min.z);
+
+    if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+      return false;
+  }
+
+  return true;
+}
+
+bool Frustum::intersects(const glm::vec3& center, float radius) const
+{
+  for (auto& plane : _planes)
+  {
+    if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+      return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,26 @@
+#ifndef WILT_FRUSTUM_H
+#define WILT_FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+#include "../utilities/bounds.h"
+
+// The six planes of a view volume, taken from a projection * view matrix so
+// things that can't be on screen can be skipped before they're drawn.
+class Frustum
+{
+private:
+  glm::vec4 _planes[6]; // normals point inwards, w is the distance
+
+public:
+  Frustum(const glm::mat4& viewProjection);
+
+public:
+  // both are conservative, a box or sphere that's outside but close to a
+  // corner may still count as intersecting
+  bool intersects(const Bounds& bounds) const;
+  bool intersects(const glm::vec3& center, float radius) const;
+
+}; // class Frustum
+
+#endif // !WILT_FRUSTUM_H
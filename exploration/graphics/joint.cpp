@@ -13,6 +13,11 @@ Joint::Joint(int parentIndex, glm::vec3 location, glm::quat rotation)
   _transform = locationTransform * rotationTransform;
 }
 
+Joint::Joint(int parentIndex, const glm::mat4& transform)
+  : _parentIndex{ parentIndex }
+  , _transform{ transform }
+{ }
+
 int Joint::parentIndex() const
 {
   return _parentIndex;
@@ -5,6 +5,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+constexpr int MAX_JOINTS = 24; // the most a skinned model can have
+
 class Joint
 {
 public:
@@ -14,6 +16,7 @@ public:
 public:
   Joint();
   Joint(int parentIndex, glm::vec3 location, glm::quat rotation);
+  Joint(int parentIndex, const glm::mat4& transform);
   Joint(const Joint&) = default;
   Joint(Joint&&) = default;
   Joint& operator= (const Joint&) = default;
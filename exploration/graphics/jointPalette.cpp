@@ -0,0 +1,98 @@
+#include "jointPalette.h"
+
+#include <algorithm>
+#include <utility>
+
+JointPalette::JointPalette()
+  : _id{ 0 }
+  , _capacity{ 0 }
+{ }
+
+JointPalette::JointPalette(JointPalette&& s)
+  : _id{ s._id }
+  , _capacity{ s._capacity }
+  , _transforms{ std::move(s._transforms) }
+{
+  s._id = 0;
+  s._capacity = 0;
+}
+
+JointPalette& JointPalette::operator= (JointPalette&& s)
+{
+  release();
+
+  _id = s._id;
+  _capacity = s._capacity;
+  _transforms = std::move(s._transforms);
+  s._id = 0;
+  s._capacity = 0;
+
+  return *this;
+}
+
+JointPalette::~JointPalette()
+{
+  release();
+}
+
+GLuint JointPalette::id()
+{
+  return _id;
+}
+
+void JointPalette::release()
+{
+  if (_id != 0)
+  {
+    glDeleteBuffers(1, &_id);
+    _id = 0;
+    _capacity = 0;
+  }
+}
+
+bool JointPalette::loaded() const
+{
+  return _id != 0;
+}
+
+void JointPalette::clear()
+{
+  _transforms.clear();
+}
+
+int JointPalette::allocate(int count)
+{
+  auto offset = (int)_transforms.size();
+  _transforms.resize(_transforms.size() + count, glm::mat4());
+  return offset;
+}
+
+glm::mat4* JointPalette::transforms(int offset)
+{
+  return _transforms.data() + offset;
+}
+
+void JointPalette::upload()
+{
+  if (_transforms.empty())
+    return;
+
+  auto size = (GLsizeiptr)(_transforms.size() * sizeof(glm::mat4));
+  if (_id == 0)
+    glCreateBuffers(1, &_id);
+
+  if (size > _capacity)
+  {
+    // grows by doubling so a changing crowd doesn't reallocate every frame
+    _capacity = std::max(size, _capacity * 2);
+    glNamedBufferData(_id, _capacity, nullptr, GL_STREAM_DRAW);
+  }
+  else
+  {
+    // orphaned so the driver doesn't wait on last frame's draws
+    glInvalidateBufferData(_id);
+  }
+
+  glNamedBufferSubData(_id, 0, size, _transforms.data());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BINDING, _id);
+}
@@ -0,0 +1,50 @@
+#ifndef WILT_JOINTPALETTE_H
+#define WILT_JOINTPALETTE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// The joint transforms of every animated entity drawn this frame, packed one
+// after another. Entities allocate their range and fill it before the passes,
+// upload() sends it all in one go, and the skinned programs find it at BINDING
+// and only need the offset per draw.
+class JointPalette
+{
+private:
+  GLuint _id;
+  GLsizeiptr _capacity;
+  std::vector<glm::mat4> _transforms;
+
+public:
+  JointPalette();
+  JointPalette(const JointPalette& s) = delete;
+  JointPalette(JointPalette&& s);
+
+  JointPalette& operator= (const JointPalette& s) = delete;
+  JointPalette& operator= (JointPalette&& s);
+
+  ~JointPalette();
+
+public:
+  GLuint id();
+  void release();
+  bool loaded() const;
+
+public:
+  // starts a new frame, earlier offsets are no longer valid
+  void clear();
+
+  // reserves count transforms, set to identity, and returns their offset
+  int allocate(int count);
+  glm::mat4* transforms(int offset);
+
+  void upload();
+
+public:
+  static const GLuint BINDING = 1;
+
+}; // class JointPalette
+
+#endif // !WILT_JOINTPALETTE_H
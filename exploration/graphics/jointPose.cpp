@@ -11,10 +11,12 @@ JointPose::JointPose(glm::vec3 location, glm::quat rotation)
 
 glm::mat4 JointPose::calcLocalTransform() const
 {
-  glm::mat4 locationTransform = glm::translate(glm::mat4(), { location.x, -location.z, location.y });
-  glm::mat4 rotationTransform = (glm::mat4)glm::quat(rotation.w, rotation.x, -rotation.z, rotation.y);
+  // the rotation with the location as its translation column, the same as
+  // translating after rotating without multiplying two matrices
+  glm::mat4 transform = (glm::mat4)glm::quat(rotation.w, rotation.x, -rotation.z, rotation.y);
+  transform[3] = glm::vec4(location.x, -location.z, location.y, 1.0f);
 
-  return locationTransform * rotationTransform;
+  return transform;
 }
 
 JointPose JointPose::interpolate(const JointPose& joint1, const JointPose& joint2, float interp)
@@ -22,8 +24,5 @@ JointPose JointPose::interpolate(const JointPose& joint1, const JointPose& joint
   glm::vec3 location = glm::mix(joint1.location, joint2.location, interp);
   glm::quat rotation = glm::mix(joint1.rotation, joint2.rotation, interp);
 
-  glm::mat4 locationTransform = glm::translate(glm::mat4(), { location.x, -location.z, location.y });
-  glm::mat4 rotationTransform = (glm::mat4)glm::quat(rotation.w, rotation.x, -rotation.z, rotation.y);
-
   return JointPose{ location, rotation };
 }
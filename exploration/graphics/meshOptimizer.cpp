@@ -0,0 +1,230 @@
+#include "meshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace
+{
+  const std::size_t FACE_SIZE = 3;  // indexes per triangle
+  const std::size_t LINE_SIZE = 4;  // indexes per line patch (with adjacency)
+
+  // counts vertex shader invocations for an index stream with a FIFO cache
+  std::size_t countCacheMisses(ArrayView<const unsigned int> indexes, std::size_t vertexCount, std::size_t cacheSize)
+  {
+    // each vertex remembers when it entered the cache, it is still cached if
+    // fewer than cacheSize misses have happened since
+    std::vector<std::size_t> entered(vertexCount, 0);
+    std::size_t misses = 0;
+
+    for (auto index : indexes)
+    {
+      if (index >= vertexCount)
+        continue;
+
+      if (entered[index] == 0 || misses - entered[index] + 1 > cacheSize)
+      {
+        misses += 1;
+        entered[index] = misses;
+      }
+    }
+
+    return misses;
+  }
+
+  // Forsyth's scoring, favouring recently used vertices (but not those of the
+  // last triangle) and vertices with few triangles left to draw
+  const std::size_t SCORE_CACHE_SIZE = 32;
+  const float CACHE_DECAY_POWER = 1.5f;
+  const float LAST_TRIANGLE_SCORE = 0.75f;
+  const float VALENCE_BOOST_SCALE = 2.0f;
+  const float VALENCE_BOOST_POWER = 0.5f;
+
+  float vertexScore(int cachePosition, unsigned int remainingTriangles)
+  {
+    if (remainingTriangles == 0)
+      return -1.0f;
+
+    auto score = 0.0f;
+    if (cachePosition >= 0)
+    {
+      if (cachePosition < (int)FACE_SIZE)
+        score = LAST_TRIANGLE_SCORE;
+      else
+        score = std::pow(1.0f - (cachePosition - FACE_SIZE) / (float)(SCORE_CACHE_SIZE - FACE_SIZE), CACHE_DECAY_POWER);
+    }
+
+    return score + VALENCE_BOOST_SCALE * std::pow((float)remainingTriangles, -VALENCE_BOOST_POWER);
+  }
+
+  std::vector<unsigned int> optimizeFaceOrder(const std::vector<unsigned int>& faceIndexes, std::size_t vertexCount)
+  {
+    auto faceCount = faceIndexes.size() / FACE_SIZE;
+
+    // triangles adjacent to each vertex, as a flattened list
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (auto index : faceIndexes)
+      remaining[index] += 1;
+
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+    for (std::size_t i = 0; i < vertexCount; ++i)
+      adjacencyOffsets[i + 1] = adjacencyOffsets[i] + remaining[i];
+
+    std::vector<unsigned int> adjacency(faceIndexes.size());
+    std::vector<unsigned int> filled(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (std::size_t i = 0; i < faceIndexes.size(); ++i)
+      adjacency[filled[faceIndexes[i]]++] = (unsigned int)(i / FACE_SIZE);
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (std::size_t i = 0; i < vertexCount; ++i)
+      vertexScores[i] = vertexScore(-1, remaining[i]);
+
+    std::vector<float> faceScores(faceCount);
+    for (std::size_t i = 0; i < faceCount; ++i)
+    {
+      auto face = &faceIndexes[i * FACE_SIZE];
+      faceScores[i] = vertexScores[face[0]] + vertexScores[face[1]] + vertexScores[face[2]];
+    }
+
+    std::vector<bool> emitted(faceCount, false);
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> result;
+    result.reserve(faceIndexes.size());
+
+    std::size_t nextUnemitted = 0;
+    auto bestFace = faceCount;
+
+    for (std::size_t emittedCount = 0; emittedCount < faceCount; ++emittedCount)
+    {
+      // nothing in the cache to continue from, take the next unemitted
+      // triangle in the original order
+      if (bestFace == faceCount)
+      {
+        while (emitted[nextUnemitted])
+          ++nextUnemitted;
+        bestFace = nextUnemitted;
+      }
+
+      auto face = &faceIndexes[bestFace * FACE_SIZE];
+      result.insert(result.end(), face, face + FACE_SIZE);
+      emitted[bestFace] = true;
+
+      // move the triangle's vertices to the front of the cache
+      std::vector<unsigned int> newCache(face, face + FACE_SIZE);
+      for (auto vertex : cache)
+      {
+        if (vertex != face[0] && vertex != face[1] && vertex != face[2])
+          newCache.push_back(vertex);
+      }
+
+      for (std::size_t i = 0; i < FACE_SIZE; ++i)
+        remaining[face[i]] -= 1;
+
+      // rescore everything the cache touched, including what just fell out
+      for (std::size_t i = 0; i < newCache.size(); ++i)
+      {
+        auto vertex = newCache[i];
+        cachePositions[vertex] = i < SCORE_CACHE_SIZE ? (int)i : -1;
+        vertexScores[vertex] = vertexScore(cachePositions[vertex], remaining[vertex]);
+      }
+      if (newCache.size() > SCORE_CACHE_SIZE)
+        newCache.resize(SCORE_CACHE_SIZE);
+      cache = std::move(newCache);
+
+      bestFace = faceCount;
+      auto bestScore = -1.0f;
+      for (auto vertex : cache)
+      {
+        for (auto i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; ++i)
+        {
+          auto adjacentFace = adjacency[i];
+          if (emitted[adjacentFace])
+            continue;
+
+          auto adjacent = &faceIndexes[adjacentFace * FACE_SIZE];
+          faceScores[adjacentFace] = vertexScores[adjacent[0]] + vertexScores[adjacent[1]] + vertexScores[adjacent[2]];
+          if (faceScores[adjacentFace] > bestScore)
+          {
+            bestScore = faceScores[adjacentFace];
+            bestFace = adjacentFace;
+          }
+        }
+      }
+    }
+
+    return result;
+  }
+}
+
+MeshCacheStatistics analyzeMeshCache(ArrayView<const unsigned int> faceIndexes, ArrayView<const unsigned int> lineIndexes, std::size_t vertexCount)
+{
+  const std::size_t CACHE_SIZE = 16;
+
+  auto faceCount = faceIndexes.size() / FACE_SIZE;
+  auto lineCount = lineIndexes.size() / LINE_SIZE;
+
+  MeshCacheStatistics statistics;
+  statistics.faceACMR = faceCount == 0 ? 0.0f : countCacheMisses(faceIndexes, vertexCount, CACHE_SIZE) / (float)faceCount;
+  statistics.lineACMR = lineCount == 0 ? 0.0f : countCacheMisses(lineIndexes, vertexCount, CACHE_SIZE) / (float)lineCount;
+  return statistics;
+}
+
+void optimizeMesh(std::vector<float>& vertexData, std::size_t vertexStride, std::vector<unsigned int>& faceIndexes, std::vector<unsigned int>& lineIndexes)
+{
+  auto vertexCount = vertexData.size() / vertexStride;
+
+  // leave meshes with out of range indexes alone rather than guess
+  for (auto index : faceIndexes)
+    if (index >= vertexCount)
+      return;
+  for (auto index : lineIndexes)
+    if (index >= vertexCount)
+      return;
+
+  faceIndexes = optimizeFaceOrder(faceIndexes, vertexCount);
+
+  // renumber vertices by first use, unused ones keep their relative order at
+  // the end
+  const auto UNASSIGNED = ~0u;
+  std::vector<unsigned int> remap(vertexCount, UNASSIGNED);
+  unsigned int nextVertex = 0;
+  for (auto index : faceIndexes)
+    if (remap[index] == UNASSIGNED)
+      remap[index] = nextVertex++;
+  for (auto index : lineIndexes)
+    if (remap[index] == UNASSIGNED)
+      remap[index] = nextVertex++;
+  for (auto& index : remap)
+    if (index == UNASSIGNED)
+      index = nextVertex++;
+
+  std::vector<float> remappedVertexData(vertexData.size());
+  for (std::size_t i = 0; i < vertexCount; ++i)
+    std::copy_n(&vertexData[i * vertexStride], vertexStride, &remappedVertexData[remap[i] * vertexStride]);
+  vertexData = std::move(remappedVertexData);
+
+  for (auto& index : faceIndexes)
+    index = remap[index];
+  for (auto& index : lineIndexes)
+    index = remap[index];
+
+  // the drawn edge of a patch is its middle two vertices, the outer two are
+  // only there for adjacency
+  std::vector<std::array<unsigned int, LINE_SIZE>> patches(lineIndexes.size() / LINE_SIZE);
+  for (std::size_t i = 0; i < patches.size(); ++i)
+    std::copy_n(&lineIndexes[i * LINE_SIZE], LINE_SIZE, patches[i].begin());
+
+  std::stable_sort(patches.begin(), patches.end(), [](const auto& a, const auto& b)
+  {
+    auto aFirst = std::min(a[1], a[2]);
+    auto bFirst = std::min(b[1], b[2]);
+    if (aFirst != bFirst)
+      return aFirst < bFirst;
+    return std::max(a[1], a[2]) < std::max(b[1], b[2]);
+  });
+
+  for (std::size_t i = 0; i < patches.size(); ++i)
+    std::copy_n(patches[i].begin(), LINE_SIZE, &lineIndexes[i * LINE_SIZE]);
+}
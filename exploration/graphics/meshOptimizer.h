@@ -0,0 +1,30 @@
+#ifndef WILT_MESHOPTIMIZER_H
+#define WILT_MESHOPTIMIZER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "../utilities/arrayView.h"
+
+// Average cache miss ratio (vertex shader runs per primitive) of a model's
+// index buffers, simulated with a 16 entry FIFO post-transform cache. Lower
+// is better; 0.5 is ideal for triangles on a regular grid, 3 is the worst.
+struct MeshCacheStatistics
+{
+  float faceACMR; // per triangle
+  float lineACMR; // per line patch
+
+}; // struct MeshCacheStatistics
+
+MeshCacheStatistics analyzeMeshCache(ArrayView<const unsigned int> faceIndexes, ArrayView<const unsigned int> lineIndexes, std::size_t vertexCount);
+
+// Reorders a mesh for the GPU without changing what is drawn:
+//  - triangles are reordered for post-transform cache hits (Tom Forsyth's
+//    linear-speed vertex cache optimization), keeping their winding
+//  - vertices are renumbered in the order the triangles, then lines, first
+//    use them so fetches walk the vertex buffer forwards
+//  - line patches are sorted by their renumbered edge so neighboring patches
+//    share vertices
+void optimizeMesh(std::vector<float>& vertexData, std::size_t vertexStride, std::vector<unsigned int>& faceIndexes, std::vector<unsigned int>& lineIndexes);
+
+#endif // !WILT_MESHOPTIMIZER_H
@@ -0,0 +1,192 @@
+#include "modelBuffers.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace
+{
+  const std::size_t INDEX_ALIGNMENT = 4;
+  const std::size_t MINIMUM_INSTANCE_CAPACITY = 256;
+
+  void setInstanceFormat(GLuint vertexArray)
+  {
+    for (GLuint column = 0; column < 4; ++column)
+    {
+      glEnableVertexArrayAttrib(vertexArray, 4 + column);
+      glVertexArrayAttribBinding(vertexArray, 4 + column, 1);
+      glVertexArrayAttribFormat(vertexArray, 4 + column, 4, GL_FLOAT, GL_FALSE, offsetof(ModelInstance, transform) + column * sizeof(glm::vec4));
+    }
+
+    glEnableVertexArrayAttrib(vertexArray, 8);
+    glVertexArrayAttribBinding(vertexArray, 8, 1);
+    glVertexArrayAttribFormat(vertexArray, 8, 1, GL_FLOAT, GL_FALSE, offsetof(ModelInstance, drawPercentage));
+
+    glVertexArrayBindingDivisor(vertexArray, 1, 1);
+  }
+}
+
+ModelBuffers ModelBuffers::shared;
+
+ModelBuffers::ModelBuffers()
+  : _vertices{ }
+  , _vertexArrays{ }
+  , _indexes{ }
+  , _instances{ 0 }
+  , _instanceCapacity{ 0 }
+  , _bound{ 0 }
+{ }
+
+ModelBuffers::~ModelBuffers()
+{
+  // there is no context left by the time statics are destroyed, release() is
+  // called before the window goes away
+}
+
+ModelBuffers::Range ModelBuffers::addVertices(VertexLayout layout, ArrayView<const unsigned char> data)
+{
+  auto& arena = _vertices[(std::size_t)layout];
+
+  Range range;
+  range.offset = arena.allocate(data.bytes(), vertexStride(layout));
+  range.bytes = data.bytes();
+  arena.write(range.offset, data.data(), data.bytes());
+
+  attachBuffers();
+  return range;
+}
+
+ModelBuffers::Range ModelBuffers::addIndexes(ArrayView<const unsigned char> data)
+{
+  Range range;
+  range.offset = _indexes.allocate(data.bytes(), INDEX_ALIGNMENT);
+  range.bytes = data.bytes();
+  _indexes.write(range.offset, data.data(), data.bytes());
+
+  attachBuffers();
+  return range;
+}
+
+void ModelBuffers::updateVertices(VertexLayout layout, Range& range, ArrayView<const unsigned char> data)
+{
+  if (range.bytes == data.bytes())
+  {
+    _vertices[(std::size_t)layout].write(range.offset, data.data(), data.bytes());
+    return;
+  }
+
+  removeVertices(layout, range);
+  range = addVertices(layout, data);
+}
+
+void ModelBuffers::updateIndexes(Range& range, ArrayView<const unsigned char> data)
+{
+  if (range.bytes == data.bytes())
+  {
+    _indexes.write(range.offset, data.data(), data.bytes());
+    return;
+  }
+
+  removeIndexes(range);
+  range = addIndexes(data);
+}
+
+void ModelBuffers::removeVertices(VertexLayout layout, Range& range)
+{
+  _vertices[(std::size_t)layout].free(range.offset, range.bytes);
+  range = Range{};
+}
+
+void ModelBuffers::removeIndexes(Range& range)
+{
+  _indexes.free(range.offset, range.bytes);
+  range = Range{};
+}
+
+void ModelBuffers::writeInstances(ArrayView<const ModelInstance> instances)
+{
+  if (_instances == 0)
+    attachBuffers();
+  if (instances.size() > _instanceCapacity)
+    _instanceCapacity = std::max(instances.size(), _instanceCapacity * 2);
+
+  // the old contents may still be in use by the last frame's draws, so the
+  // storage is orphaned rather than written over
+  glNamedBufferData(_instances, _instanceCapacity * sizeof(ModelInstance), nullptr, GL_STREAM_DRAW);
+  glNamedBufferSubData(_instances, 0, instances.bytes(), instances.data());
+}
+
+void ModelBuffers::bind(VertexLayout layout)
+{
+  auto id = vertexArray(layout);
+  if (_bound == id)
+    return;
+
+  glBindVertexArray(id);
+  _bound = id;
+}
+
+void ModelBuffers::unbind()
+{
+  glBindVertexArray(0);
+  _bound = 0;
+}
+
+void ModelBuffers::release()
+{
+  for (auto& id : _vertexArrays)
+  {
+    if (id != 0)
+      glDeleteVertexArrays(1, &id);
+    id = 0;
+  }
+
+  for (auto& arena : _vertices)
+    arena.release();
+  _indexes.release();
+
+  if (_instances != 0)
+    glDeleteBuffers(1, &_instances);
+  _instances = 0;
+  _instanceCapacity = 0;
+  _bound = 0;
+}
+
+GLuint ModelBuffers::vertexArray(VertexLayout layout)
+{
+  auto& id = _vertexArrays[(std::size_t)layout];
+  if (id == 0)
+  {
+    glCreateVertexArrays(1, &id);
+    setVertexFormat(id, layout);
+    setInstanceFormat(id);
+    attachBuffers();
+  }
+
+  return id;
+}
+
+void ModelBuffers::attachBuffers()
+{
+  // draws that aren't instanced still read the instance attributes (and
+  // ignore them), so there is always an instance buffer to read from
+  if (_instances == 0)
+  {
+    _instanceCapacity = std::max(_instanceCapacity, MINIMUM_INSTANCE_CAPACITY);
+    glCreateBuffers(1, &_instances);
+    glNamedBufferData(_instances, _instanceCapacity * sizeof(ModelInstance), nullptr, GL_STREAM_DRAW);
+  }
+
+  // the arenas swap their buffers when they grow, so the vertex arrays are
+  // pointed at whatever the current ones are
+  for (std::size_t i = 0; i < VERTEX_LAYOUT_COUNT; ++i)
+  {
+    auto id = _vertexArrays[i];
+    if (id == 0)
+      continue;
+
+    auto layout = (VertexLayout)i;
+    glVertexArrayVertexBuffer(id, 0, _vertices[i].id(), 0, (GLsizei)vertexStride(layout));
+    glVertexArrayElementBuffer(id, _indexes.id());
+    glVertexArrayVertexBuffer(id, 1, _instances, 0, sizeof(ModelInstance));
+  }
+}
@@ -0,0 +1,84 @@
+#ifndef WILT_MODELBUFFERS_H
+#define WILT_MODELBUFFERS_H
+
+#include <array>
+#include <cstddef>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "bufferArena.h"
+#include "vertexLayout.h"
+#include "../utilities/arrayView.h"
+
+// Per-instance data for instanced draws, read by the vertex shaders as
+// attributes 4 to 7 (the transform's columns) and 8.
+struct ModelInstance
+{
+  glm::mat4 transform;
+  float drawPercentage;
+  float padding[3];
+};
+
+// Holds every model's vertices and indexes in a few shared buffers: one vertex
+// arena per vertex layout and one index arena. Each layout has one vertex
+// array that all models with that layout draw through, with the model's
+// vertices found by base vertex and its indexes by offset, so consecutive
+// draws don't need to rebind anything. The vertex arrays also read the
+// instance buffer, which holds the instances of the draws being made.
+class ModelBuffers
+{
+public:
+  struct Range
+  {
+    std::size_t offset = 0;
+    std::size_t bytes = 0;
+  };
+
+private:
+  std::array<BufferArena, VERTEX_LAYOUT_COUNT> _vertices;
+  std::array<GLuint, VERTEX_LAYOUT_COUNT> _vertexArrays;
+  BufferArena _indexes;
+  GLuint _instances;
+  std::size_t _instanceCapacity;
+  GLuint _bound;
+
+public:
+  ModelBuffers();
+  ModelBuffers(const ModelBuffers& s) = delete;
+  ModelBuffers& operator= (const ModelBuffers& s) = delete;
+  ~ModelBuffers();
+
+public:
+  Range addVertices(VertexLayout layout, ArrayView<const unsigned char> data);
+  Range addIndexes(ArrayView<const unsigned char> data);
+
+  // writes in place when the size is unchanged, otherwise moves the range
+  void updateVertices(VertexLayout layout, Range& range, ArrayView<const unsigned char> data);
+  void updateIndexes(Range& range, ArrayView<const unsigned char> data);
+
+  void removeVertices(VertexLayout layout, Range& range);
+  void removeIndexes(Range& range);
+
+  // replaces the contents of the instance buffer, instanced draws then pick
+  // their instances out of it with a base instance
+  void writeInstances(ArrayView<const ModelInstance> instances);
+
+  // binds the layout's vertex array unless it already is, the cached binding
+  // is only valid between unbind() calls so passes that bind other vertex
+  // arrays have to call unbind() when they're done with the models
+  void bind(VertexLayout layout);
+  void unbind();
+
+  void release();
+
+public:
+  static ModelBuffers shared;
+
+private:
+  GLuint vertexArray(VertexLayout layout);
+  void attachBuffers();
+
+}; // class ModelBuffers
+
+#endif // !WILT_MODELBUFFERS_H
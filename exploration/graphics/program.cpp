@@ -5,14 +5,19 @@ namespace { auto logger = wilt::logging.createLogger("graphics-program"); }
 
 Program::Program()
   : _id{ 0 }
+  , _uniformLocations{ }
 { }
 
 Program::Program(GLuint id)
   : _id{ id }
-{ }
+  , _uniformLocations{ }
+{
+  if (_id != 0)
+    loadUniformLocations();
+}
 
-Program::Program(Shader fragmentShader)
-  : Program{ Shader{}, Shader{}, Shader{}, Shader{}, std::move(fragmentShader) }
+Program::Program(Shader shader)
+  : Program{ Shader{}, Shader{}, Shader{}, Shader{}, std::move(shader) }
 { }
 
 Program::Program(Shader vertexShader, Shader fragmentShader)
@@ -25,6 +30,7 @@ Program::Program(Shader vertexShader, Shader geometryShader, Shader fragmentShad
 
 Program::Program(Shader vertexShader, Shader tessellationControlShader, Shader tessellationEvaluationShader, Shader geometryShader, Shader fragmentShader)
   : _id{ 0 }
+  , _uniformLocations{ }
 {
   _id = glCreateProgram();
 
@@ -50,13 +56,18 @@ Program::Program(Shader vertexShader, Shader tessellationControlShader, Shader t
     logger.error(std::string("linking program: ") + error);
     glDeleteProgram(_id);
     _id = 0;
+    return;
   }
+
+  loadUniformLocations();
 }
 
 Program::Program(Program&& s)
   : _id{ s._id }
+  , _uniformLocations{ std::move(s._uniformLocations) }
 {
   s._id = 0;
+  s._uniformLocations.clear();
 }
 
 Program& Program::operator= (Program&& s)
@@ -64,7 +75,9 @@ Program& Program::operator= (Program&& s)
   release();
 
   _id = s._id;
+  _uniformLocations = std::move(s._uniformLocations);
   s._id = 0;
+  s._uniformLocations.clear();
 
   return *this;
 }
@@ -74,7 +87,7 @@ Program::~Program()
   release();
 }
 
-GLuint Program::id()
+GLuint Program::id() const
 {
   return _id;
 }
@@ -91,105 +104,93 @@ void Program::release()
     glDeleteProgram(_id);
     _id = 0;
   }
+
+  _uniformLocations.clear();
 }
 
-namespace {
-  // TODO: move this to a utility function or something
+GLint Program::uniformLocation(std::string_view name) const
+{
+  auto found = _uniformLocations.find(name);
+  if (found != _uniformLocations.end())
+    return found->second;
+
+  // e.g. an element past the first of an array, or a uniform that was
+  // optimized out
+  auto location = glGetUniformLocation(_id, std::string(name).c_str());
+  _uniformLocations.emplace(name, location);
+  return location;
+}
+
+void Program::loadUniformLocations()
+{
+  GLint count = 0;
+  GLint maxLength = 0;
+  glGetProgramiv(_id, GL_ACTIVE_UNIFORMS, &count);
+  glGetProgramiv(_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
 
-  void logError(const std::string &name)
+  std::string name;
+  for (GLint i = 0; i < count; ++i)
   {
-    auto error = glGetError();
-    if (error == GL_NO_ERROR)
-      return;
-
-    switch (error)
-    {
-    case GL_INVALID_ENUM:
-      logger.error("GL_INVALID_ENUM");
-      logger.error(name);
-      break;
-    case GL_INVALID_VALUE:
-      logger.error("GL_INVALID_VALUE");
-      logger.error(name);
-      break;
-    case GL_INVALID_OPERATION:
-      logger.error("GL_INVALID_OPERATION");
-      logger.error(name);
-      break;
-    case GL_INVALID_FRAMEBUFFER_OPERATION:
-      logger.error("GL_INVALID_FRAMEBUFFER_OPERATION");
-      logger.error(name);
-      break;
-    case GL_OUT_OF_MEMORY:
-      logger.error("GL_OUT_OF_MEMORY");
-      logger.error(name);
-      break;
-    case GL_STACK_UNDERFLOW:
-      logger.error("GL_STACK_UNDERFLOW");
-      logger.error(name);
-      break;
-    case GL_STACK_OVERFLOW:
-      logger.error("GL_STACK_OVERFLOW");
-      logger.error(name);
-      break;
-    default:
-      logger.error("UNKNOWN");
-      logger.error(name);
-      break;
-    }
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = 0;
+    name.resize(maxLength);
+    glGetActiveUniform(_id, (GLuint)i, maxLength, &length, &size, &type, &name[0]);
+    name.resize(length);
+
+    // members of uniform blocks have no location
+    auto location = uniformLocation(name);
+    if (location < 0)
+      continue;
+
+    // arrays are listed as "name[0]" but are usually set as "name"
+    _uniformLocations[name] = location;
+    if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+      _uniformLocations[name.substr(0, name.size() - 3)] = location;
   }
 }
 
-void Program::setBool(const std::string &name, bool value) const
+void Program::setBool(std::string_view name, bool value) const
 {
-  glUniform1i(glGetUniformLocation(_id, name.c_str()), (int)value);
-  logError(name);
+  glUniform1i(uniformLocation(name), (int)value);
 }
 
-void Program::setInt(const std::string &name, int value) const
+void Program::setInt(std::string_view name, int value) const
 {
-  glUniform1i(glGetUniformLocation(_id, name.c_str()), value);
-  logError(name);
+  glUniform1i(uniformLocation(name), value);
 }
 
-void Program::setFloat(const std::string &name, float value) const
+void Program::setFloat(std::string_view name, float value) const
 {
-  glUniform1f(glGetUniformLocation(_id, name.c_str()), value);
-  logError(name);
+  glUniform1f(uniformLocation(name), value);
 }
 
-void Program::setVec2(const std::string &name, const glm::vec2 &value) const
+void Program::setVec2(std::string_view name, const glm::vec2 &value) const
 {
-  glUniform2fv(glGetUniformLocation(_id, name.c_str()), 1, &value[0]);
-  logError(name);
+  glUniform2fv(uniformLocation(name), 1, &value[0]);
 }
 
-void Program::setVec3(const std::string &name, const glm::vec3 &value) const
+void Program::setVec3(std::string_view name, const glm::vec3 &value) const
 {
-  glUniform3fv(glGetUniformLocation(_id, name.c_str()), 1, &value[0]);
-  logError(name);
+  glUniform3fv(uniformLocation(name), 1, &value[0]);
 }
 
-void Program::setVec4(const std::string &name, const glm::vec4 &value) const
+void Program::setVec4(std::string_view name, const glm::vec4 &value) const
 {
-  glUniform4fv(glGetUniformLocation(_id, name.c_str()), 1, &value[0]);
-  logError(name);
+  glUniform4fv(uniformLocation(name), 1, &value[0]);
 }
 
-void Program::setMat2(const std::string &name, const glm::mat2 &mat) const
+void Program::setMat2(std::string_view name, const glm::mat2 &mat) const
 {
-  glUniformMatrix2fv(glGetUniformLocation(_id, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-  logError(name);
+  glUniformMatrix2fv(uniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
-void Program::setMat3(const std::string &name, const glm::mat3 &mat) const
+void Program::setMat3(std::string_view name, const glm::mat3 &mat) const
 {
-  glUniformMatrix3fv(glGetUniformLocation(_id, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-  logError(name);
+  glUniformMatrix3fv(uniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
-void Program::setMat4(const std::string &name, const glm::mat4 &mat) const
+void Program::setMat4(std::string_view name, const glm::mat4 &mat) const
 {
-  glUniformMatrix4fv(glGetUniformLocation(_id, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-  logError(name);
+  glUniformMatrix4fv(uniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
@@ -1,7 +1,9 @@
 #ifndef WILT_PROGRAM_H
 #define WILT_PROGRAM_H
 
+#include <map>
 #include <string>
+#include <string_view>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -13,10 +15,14 @@ class Program
 protected:
   GLuint _id;
 
+  // filled from the active uniforms when linked, names not found there are
+  // looked up once and remembered (as -1 if the program doesn't have them)
+  mutable std::map<std::string, GLint, std::less<>> _uniformLocations;
+
 public:
   Program();
   explicit Program(GLuint id);
-  explicit Program(Shader fragmentShader);
+  explicit Program(Shader shader); // a compute shader, or a fragment shader alone
   Program(Shader vertexShader, Shader fragmentShader);
   Program(Shader vertexShader, Shader geometryShader, Shader fragmentShader);
   Program(Shader vertexShader, Shader tessellationControlShader, Shader tessellationEvaluationShader, Shader geometryShader, Shader fragmentShader);
@@ -29,20 +35,24 @@ public:
   ~Program();
 
 public:
-  GLuint id();
+  GLuint id() const;
   void use();
   void release();
+  GLint uniformLocation(std::string_view name) const;
 
 public:
-  void setBool(const std::string &name, bool value) const;
-  void setInt(const std::string &name, int value) const;
-  void setFloat(const std::string &name, float value) const;
-  void setVec2(const std::string &name, const glm::vec2 &value) const;
-  void setVec3(const std::string &name, const glm::vec3 &value) const;
-  void setVec4(const std::string &name, const glm::vec4 &value) const;
-  void setMat2(const std::string &name, const glm::mat2 &mat) const;
-  void setMat3(const std::string &name, const glm::mat3 &mat) const;
-  void setMat4(const std::string &name, const glm::mat4 &mat) const;
+  void setBool(std::string_view name, bool value) const;
+  void setInt(std::string_view name, int value) const;
+  void setFloat(std::string_view name, float value) const;
+  void setVec2(std::string_view name, const glm::vec2 &value) const;
+  void setVec3(std::string_view name, const glm::vec3 &value) const;
+  void setVec4(std::string_view name, const glm::vec4 &value) const;
+  void setMat2(std::string_view name, const glm::mat2 &mat) const;
+  void setMat3(std::string_view name, const glm::mat3 &mat) const;
+  void setMat4(std::string_view name, const glm::mat4 &mat) const;
+
+private:
+  void loadUniformLocations();
 
 }; // class Program
 
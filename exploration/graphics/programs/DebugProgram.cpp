@@ -29,9 +29,7 @@ DebugProgram::DebugProgram(Shader vertexShader, Shader fragmentShader)
   if (_id == 0)
     return;
 
-  locationProjection = glGetUniformLocation(_id, "projection");
-  locationView       = glGetUniformLocation(_id, "view");
-  locationModel      = glGetUniformLocation(_id, "model");
+  locationModel = glGetUniformLocation(_id, "model");
 
   glGenVertexArrays(1, &boxVAO);
   glGenBuffers(1, &boxVBO);
@@ -48,16 +46,6 @@ DebugProgram::~DebugProgram()
   glDeleteBuffers(1, &boxVBO);
 }
 
-void DebugProgram::setProjection(const glm::mat4& mat) const
-{
-  glUniformMatrix4fv(locationProjection, 1, GL_FALSE, &mat[0][0]);
-}
-
-void DebugProgram::setView(const glm::mat4& mat) const
-{
-  glUniformMatrix4fv(locationView, 1, GL_FALSE, &mat[0][0]);
-}
-
 void DebugProgram::setModel(const glm::mat4& mat) const
 {
   glUniformMatrix4fv(locationModel, 1, GL_FALSE, &mat[0][0]);
@@ -8,8 +8,6 @@
 class DebugProgram : public Program
 {
 private:
-  GLint locationProjection;
-  GLint locationView;
   GLint locationModel;
 
   GLuint boxVAO;
@@ -21,8 +19,6 @@ public:
   ~DebugProgram();
 
 public:
-  void setProjection(const glm::mat4 &mat) const;
-  void setView(const glm::mat4 &mat) const;
   void setModel(const glm::mat4 &mat) const;
 
 public:
@@ -1,69 +1,83 @@
 #include "DepthProgram.h"
 
-DepthProgram::DepthProgram(Shader vertexShader, Shader geometryShader, Shader fragmentShader)
+DepthProgram::DepthProgram(Shader vertexShader, Shader geometryShader, Shader fragmentShader,
+                           Shader unskinnedVertexShader, Shader unskinnedGeometryShader, Shader unskinnedFragmentShader)
   : Program{ std::move(vertexShader), std::move(geometryShader), std::move(fragmentShader) }
+  , unskinned{ std::move(unskinnedVertexShader), std::move(unskinnedGeometryShader), std::move(unskinnedFragmentShader) }
+  , skinned{ true }
 {
   if (_id == 0)
     return;
 
-  locationProjection          = glGetUniformLocation(_id, "projection");
-  locationView                = glGetUniformLocation(_id, "view");
-  locationReferenceProjection = glGetUniformLocation(_id, "reference_projection");
-  locationReferenceView       = glGetUniformLocation(_id, "reference_view");
-  locationViewReference       = glGetUniformLocation(_id, "viewReference");
-  locationRatio               = glGetUniformLocation(_id, "ratio");
-  locationFrame               = glGetUniformLocation(_id, "frame");
-  locationPositions           = glGetUniformLocation(_id, "positions");
-  locationDrawPercentage      = glGetUniformLocation(_id, "draw_percentage");
-  locationModel               = glGetUniformLocation(_id, "model");
-}
+  // the program is only usable if both variants linked
+  if (unskinned.id() == 0)
+  {
+    release();
+    return;
+  }
 
-void DepthProgram::setProjection(const glm::mat4& mat) const
-{
-  glUniformMatrix4fv(locationProjection, 1, GL_FALSE, &mat[0][0]);
+  GLuint ids[2] = { _id, unskinned.id() };
+  for (int i = 0; i < 2; ++i)
+  {
+    auto& variant = variants[i];
+    variant.id                     = ids[i];
+    variant.locationFrame          = glGetUniformLocation(ids[i], "frame");
+    variant.locationCode           = glGetUniformLocation(ids[i], "code");
+    variant.locationPaletteOffset  = glGetUniformLocation(ids[i], "palette_offset");
+    variant.locationDrawPercentage = glGetUniformLocation(ids[i], "draw_percentage");
+    variant.locationModel          = glGetUniformLocation(ids[i], "model");
+    variant.locationInstanced      = glGetUniformLocation(ids[i], "instanced");
+  }
 }
 
-void DepthProgram::setView(const glm::mat4& mat) const
+void DepthProgram::use()
 {
-  glUniformMatrix4fv(locationView, 1, GL_FALSE, &mat[0][0]);
+  Program::use();
+  skinned = true;
 }
 
-void DepthProgram::setReferenceProjection(const glm::mat4& mat) const
+void DepthProgram::setSkinned(bool val)
 {
-  glUniformMatrix4fv(locationReferenceProjection, 1, GL_FALSE, &mat[0][0]);
-}
+  if (skinned == val)
+    return;
 
-void DepthProgram::setReferenceView(const glm::mat4& mat) const
-{
-  glUniformMatrix4fv(locationReferenceView, 1, GL_FALSE, &mat[0][0]);
+  skinned = val;
+  glUseProgram(skinned ? _id : unskinned.id());
 }
 
-void DepthProgram::setViewReference(const glm::vec3& vec) const
+void DepthProgram::setFrame(float val) const
 {
-  glUniform3fv(locationViewReference, 1, &vec[0]);
+  for (auto& variant : variants)
+    glProgramUniform1f(variant.id, variant.locationFrame, val);
 }
 
-void DepthProgram::setRatio(float val) const
+void DepthProgram::setCode(int val) const
 {
-  glUniform1f(locationRatio, val);
+  for (auto& variant : variants)
+    glProgramUniform1i(variant.id, variant.locationCode, val);
 }
 
-void DepthProgram::setFrame(float val) const
+void DepthProgram::setPaletteOffset(int val) const
 {
-  glUniform1f(locationFrame, val);
+  // only the skinned variant reads the palette
+  glProgramUniform1i(_id, variants[0].locationPaletteOffset, val);
 }
 
-void DepthProgram::setPositions(const std::array<glm::mat4, 24>& positions) const
+void DepthProgram::setDrawPercentage(float val) const
 {
-  glUniformMatrix4fv(locationPositions, 24, GL_FALSE, &positions[0][0][0]);
+  // set for every draw after setSkinned(), so only the variant in use
+  auto& variant = variants[skinned ? 0 : 1];
+  glProgramUniform1f(variant.id, variant.locationDrawPercentage, val);
 }
 
-void DepthProgram::setDrawPercentage(float val) const
+void DepthProgram::setModel(const glm::mat4& mat) const
 {
-  glUniform1f(locationDrawPercentage, val);
+  auto& variant = variants[skinned ? 0 : 1];
+  glProgramUniformMatrix4fv(variant.id, variant.locationModel, 1, GL_FALSE, &mat[0][0]);
 }
 
-void DepthProgram::setModel(const glm::mat4& mat) const
+void DepthProgram::setInstanced(bool val) const
 {
-  glUniformMatrix4fv(locationModel, 1, GL_FALSE, &mat[0][0]);
+  for (auto& variant : variants)
+    glProgramUniform1i(variant.id, variant.locationInstanced, (int)val);
 }
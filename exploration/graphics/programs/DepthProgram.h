@@ -1,38 +1,49 @@
 #ifndef WILT_DEPTHPROGRAM_H
 #define WILT_DEPTHPROGRAM_H
 
-#include <array>
 
 #include "../program.h"
 
+// Draws the faces. There are two variants: this program skins the vertices
+// with the joint positions, and one compiled with UNSKINNED defined only uses
+// the model transform. setSkinned() picks the one the next draws use; the
+// per-draw setters (model and draw percentage) only write that one, the rest
+// write to both.
 class DepthProgram : public Program
 {
 private:
-  GLint locationProjection;
-  GLint locationView;
-  GLint locationReferenceProjection;
-  GLint locationReferenceView;
-  GLint locationViewReference;
-  GLint locationRatio;
-  GLint locationFrame;
-  GLint locationPositions;
-  GLint locationDrawPercentage;
-  GLint locationModel;
+  struct Variant
+  {
+    GLuint id;
+    GLint locationFrame;
+    GLint locationCode;
+    GLint locationPaletteOffset;
+    GLint locationDrawPercentage;
+    GLint locationModel;
+    GLint locationInstanced;
+  };
+
+  Program unskinned;
+  Variant variants[2]; // skinned, unskinned
+  bool skinned;
+
+public:
+  DepthProgram(Shader vertexShader, Shader geometryShader, Shader fragmentShader,
+               Shader unskinnedVertexShader, Shader unskinnedGeometryShader, Shader unskinnedFragmentShader);
 
 public:
-  DepthProgram(Shader vertexShader, Shader geometryShader, Shader fragmentShader);
+  void use();
+
+  // switches variant while the program is in use, use() starts skinned
+  void setSkinned(bool val);
 
 public:
-  void setProjection(const glm::mat4 &mat) const;
-  void setView(const glm::mat4 &mat) const;
-  void setReferenceProjection(const glm::mat4 &mat) const;
-  void setReferenceView(const glm::mat4 &mat) const;
-  void setViewReference(const glm::vec3 &vec) const;
-  void setRatio(float val) const;
   void setFrame(float val) const;
-  void setPositions(const std::array<glm::mat4, 24>& positions) const;
+  void setCode(int val) const;
+  void setPaletteOffset(int val) const;
   void setDrawPercentage(float val) const;
   void setModel(const glm::mat4 &mat) const;
+  void setInstanced(bool val) const;
 };
 
 #endif // !WILT_DEPTHPROGRAM_H
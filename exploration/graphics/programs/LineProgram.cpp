@@ -1,90 +1,102 @@
 #include "LineProgram.h"
 
-LineProgram::LineProgram(Shader vertexShader, Shader tessellationControlShader, Shader tessellationEvaluationShader, Shader geometryShader, Shader fragmentShader)
+LineProgram::LineProgram(Shader vertexShader, Shader tessellationControlShader, Shader tessellationEvaluationShader, Shader geometryShader, Shader fragmentShader,
+                         Shader unskinnedVertexShader, Shader unskinnedTessellationControlShader, Shader unskinnedTessellationEvaluationShader, Shader unskinnedGeometryShader, Shader unskinnedFragmentShader)
   : Program{ std::move(vertexShader), std::move(tessellationControlShader), std::move(tessellationEvaluationShader), std::move(geometryShader), std::move(fragmentShader) }
+  , unskinned{ std::move(unskinnedVertexShader), std::move(unskinnedTessellationControlShader), std::move(unskinnedTessellationEvaluationShader), std::move(unskinnedGeometryShader), std::move(unskinnedFragmentShader) }
+  , skinned{ true }
 {
   if (_id == 0)
     return;
 
-  locationProjection     = glGetUniformLocation(_id, "projection");
-  locationView           = glGetUniformLocation(_id, "view");
-  locationViewReference  = glGetUniformLocation(_id, "view_reference");
-  locationFrame          = glGetUniformLocation(_id, "frame");
-  locationPositions      = glGetUniformLocation(_id, "positions");
-  locationDrawPercentage = glGetUniformLocation(_id, "draw_percentage");
-  locationModel          = glGetUniformLocation(_id, "model");
-  locationRatio          = glGetUniformLocation(_id, "ratio");
-  locationDepthTexture   = glGetUniformLocation(_id, "depth_texture");
-  locationBurstLocations = glGetUniformLocation(_id, "burst_locations");
-  locationBurstRanges    = glGetUniformLocation(_id, "burst_ranges");
-  locationBurstCount     = glGetUniformLocation(_id, "burst_count");
-  locationCameraPosition = glGetUniformLocation(_id, "camera_position");
+  // the program is only usable if both variants linked
+  if (unskinned.id() == 0)
+  {
+    release();
+    return;
+  }
+
+  GLuint ids[2] = { _id, unskinned.id() };
+  for (int i = 0; i < 2; ++i)
+  {
+    auto& variant = variants[i];
+    variant.id                     = ids[i];
+    variant.locationFrame          = glGetUniformLocation(ids[i], "frame");
+    variant.locationPaletteOffset  = glGetUniformLocation(ids[i], "palette_offset");
+    variant.locationDrawPercentage = glGetUniformLocation(ids[i], "draw_percentage");
+    variant.locationModel          = glGetUniformLocation(ids[i], "model");
+    variant.locationInstanced      = glGetUniformLocation(ids[i], "instanced");
+    variant.locationDepthTexture   = glGetUniformLocation(ids[i], "depth_texture");
+    variant.locationBurstLocations = glGetUniformLocation(ids[i], "burst_locations");
+    variant.locationBurstRanges    = glGetUniformLocation(ids[i], "burst_ranges");
+    variant.locationBurstCount     = glGetUniformLocation(ids[i], "burst_count");
+  }
 }
 
 void LineProgram::use()
 {
   Program::use();
+  skinned = true;
 
-  if (!burstLocations.empty())
+  for (auto& variant : variants)
   {
-    glUniform3fv(locationBurstLocations, burstLocations.size(), &burstLocations[0][0]);
-    glUniform1fv(locationBurstRanges, burstRanges.size(), &burstRanges[0]);
+    if (!burstLocations.empty())
+    {
+      glProgramUniform3fv(variant.id, variant.locationBurstLocations, burstLocations.size(), &burstLocations[0][0]);
+      glProgramUniform1fv(variant.id, variant.locationBurstRanges, burstRanges.size(), &burstRanges[0]);
+    }
+    glProgramUniform1ui(variant.id, variant.locationBurstCount, burstLocations.size());
   }
-  glUniform1ui(locationBurstCount, burstLocations.size());
 }
 
-void LineProgram::setProjection(const glm::mat4& mat) const
+void LineProgram::setSkinned(bool val)
 {
-  glUniformMatrix4fv(locationProjection, 1, GL_FALSE, &mat[0][0]);
-}
-
-void LineProgram::setView(const glm::mat4& mat) const
-{
-  glUniformMatrix4fv(locationView, 1, GL_FALSE, &mat[0][0]);
-}
+  if (skinned == val)
+    return;
 
-void LineProgram::setViewReference(const glm::vec3& vec) const
-{
-  glUniform3fv(locationViewReference, 1, &vec[0]);
+  skinned = val;
+  glUseProgram(skinned ? _id : unskinned.id());
 }
 
 void LineProgram::setFrame(float val) const
 {
-  glUniform1f(locationFrame, val);
+  for (auto& variant : variants)
+    glProgramUniform1f(variant.id, variant.locationFrame, val);
 }
 
-void LineProgram::setPositions(const std::array<glm::mat4, 24>& positions) const
+void LineProgram::setPaletteOffset(int val) const
 {
-  glUniformMatrix4fv(locationPositions, 24, GL_FALSE, &positions[0][0][0]);
+  // only the skinned variant reads the palette
+  glProgramUniform1i(_id, variants[0].locationPaletteOffset, val);
 }
 
 void LineProgram::setDrawPercentage(float val) const
 {
-  glUniform1f(locationDrawPercentage, val);
+  // set for every draw after setSkinned(), so only the variant in use
+  auto& variant = variants[skinned ? 0 : 1];
+  glProgramUniform1f(variant.id, variant.locationDrawPercentage, val);
 }
 
 void LineProgram::setModel(const glm::mat4& mat) const
 {
-  glUniformMatrix4fv(locationModel, 1, GL_FALSE, &mat[0][0]);
+  auto& variant = variants[skinned ? 0 : 1];
+  glProgramUniformMatrix4fv(variant.id, variant.locationModel, 1, GL_FALSE, &mat[0][0]);
 }
 
-void LineProgram::setRatio(float val) const
+void LineProgram::setInstanced(bool val) const
 {
-  glUniform1f(locationRatio, val);
+  for (auto& variant : variants)
+    glProgramUniform1i(variant.id, variant.locationInstanced, (int)val);
 }
 
 void LineProgram::setDepthTexture(const Texture& texture) const
 {
-  glUniform1i(locationDepthTexture, 0);
+  for (auto& variant : variants)
+    glProgramUniform1i(variant.id, variant.locationDepthTexture, 0);
   glActiveTexture(GL_TEXTURE0);
   glBindTexture(texture.target(), texture.id());
 }
 
-void LineProgram::setCameraPosition(const glm::vec3& vec) const
-{
-  glUniform3fv(locationCameraPosition, 1, &vec[0]);
-}
-
 void LineProgram::addBurst(glm::vec3 location, float range)
 {
   burstLocations.push_back(location);
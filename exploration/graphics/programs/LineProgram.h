@@ -1,49 +1,53 @@
 #ifndef WILT_LINEPROGRAM_H
 #define WILT_LINEPROGRAM_H
 
-#include <array>
 #include <vector>
 
 #include "../program.h"
 #include "../texture.h"
 
+// Draws the lines, with a skinned and an unskinned variant like DepthProgram.
 class LineProgram : public Program
 {
 private:
-  GLint locationProjection;
-  GLint locationView;
-  GLint locationViewReference;
-  GLint locationFrame;
-  GLint locationPositions;
-  GLint locationDrawPercentage;
-  GLint locationModel;
-  GLint locationRatio;
-  GLint locationDepthTexture;
-  GLint locationBurstLocations;
-  GLint locationBurstRanges;
-  GLint locationBurstCount;
-  GLint locationCameraPosition;
+  struct Variant
+  {
+    GLuint id;
+    GLint locationFrame;
+    GLint locationPaletteOffset;
+    GLint locationDrawPercentage;
+    GLint locationModel;
+    GLint locationInstanced;
+    GLint locationDepthTexture;
+    GLint locationBurstLocations;
+    GLint locationBurstRanges;
+    GLint locationBurstCount;
+  };
+
+  Program unskinned;
+  Variant variants[2]; // skinned, unskinned
+  bool skinned;
 
   std::vector<glm::vec3> burstLocations;
   std::vector<float> burstRanges;
 
 public:
-  LineProgram(Shader vertexShader, Shader tessellationControlShader, Shader tessellationEvaluationShader, Shader geometryShader, Shader fragmentShader);
+  LineProgram(Shader vertexShader, Shader tessellationControlShader, Shader tessellationEvaluationShader, Shader geometryShader, Shader fragmentShader,
+              Shader unskinnedVertexShader, Shader unskinnedTessellationControlShader, Shader unskinnedTessellationEvaluationShader, Shader unskinnedGeometryShader, Shader unskinnedFragmentShader);
 
 public:
   void use();
 
+  // switches variant while the program is in use, use() starts skinned
+  void setSkinned(bool val);
+
 public:
-  void setProjection(const glm::mat4 &mat) const;
-  void setView(const glm::mat4 &mat) const;
-  void setViewReference(const glm::vec3 &vec) const;
   void setFrame(float val) const;
-  void setPositions(const std::array<glm::mat4, 24>& positions) const;
+  void setPaletteOffset(int val) const;
   void setDrawPercentage(float val) const;
   void setModel(const glm::mat4 &mat) const;
-  void setRatio(float val) const;
+  void setInstanced(bool val) const;
   void setDepthTexture(const Texture& texture) const;
-  void setCameraPosition(const glm::vec3 &vec) const;
 
   void addBurst(glm::vec3 location, float range);
   void reset();
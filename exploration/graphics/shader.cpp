@@ -1,5 +1,6 @@
 #include "shader.h"
 
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 
@@ -77,12 +78,67 @@ Shader Shader::fromMemory(const char* data, GLenum shaderType)
   return Shader{ load("<memory>", data, shaderType) };
 }
 
-Shader Shader::fromFile(const char* filename, GLenum shaderType)
+namespace
 {
-  std::ifstream file(filename);
-  std::stringstream ss;
-  std::string data;
-  ss << file.rdbuf();
-  data = ss.str();
+  std::string readShaderFile(const std::filesystem::path& filename)
+  {
+    std::ifstream file(filename);
+    if (!file)
+      logger.error("reading shader file \'" + filename.string() + "\'");
+
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+  }
+
+  // replaces each '#include "<file>"' line with the file, found next to the
+  // shader including it; included files aren't expanded themselves
+  void expandIncludes(const char* filename, std::string& data)
+  {
+    const auto directive = std::string("#include \"");
+    auto directory = std::filesystem::path(filename).parent_path();
+
+    auto position = data.find(directive);
+    while (position != std::string::npos)
+    {
+      auto lineEnd = data.find('\n', position);
+      lineEnd = lineEnd == std::string::npos ? data.size() : lineEnd;
+      auto nameStart = position + directive.size();
+      auto nameEnd = data.find('"', nameStart);
+
+      if ((position != 0 && data[position - 1] != '\n') || nameEnd == std::string::npos || nameEnd > lineEnd)
+      {
+        position = data.find(directive, lineEnd);
+        continue;
+      }
+
+      auto included = readShaderFile(directory / data.substr(nameStart, nameEnd - nameStart));
+      data.replace(position, lineEnd - position, included);
+      position = data.find(directive, position + included.size());
+    }
+  }
+}
+
+Shader Shader::fromFile(const char* filename, GLenum shaderType, std::initializer_list<const char*> defines)
+{
+  auto data = readShaderFile(filename);
+  expandIncludes(filename, data);
+
+  if (defines.size() != 0)
+  {
+    // the #version line has to stay first
+    std::string lines;
+    for (auto define : defines)
+      lines += std::string("#define ") + define + "\n";
+
+    auto position = std::size_t(0);
+    if (data.compare(0, 8, "#version") == 0)
+    {
+      position = data.find('\n');
+      position = position == std::string::npos ? data.size() : position + 1;
+    }
+    data.insert(position, lines);
+  }
+
   return Shader{ load(filename, data.data(), shaderType) };
 }
@@ -1,6 +1,9 @@
 #ifndef WILT_SHADER_H
 #define WILT_SHADER_H
 
+#include <initializer_list>
+#include <string>
+
 #include <glad/glad.h>
 
 class Shader
@@ -26,7 +29,11 @@ public:
 
 public:
   static Shader fromMemory(const char* data, GLenum shaderType);
-  static Shader fromFile(const char* filename, GLenum shaderType);
+
+  // each define is added as "#define <define>" after the #version line, so one
+  // file can be compiled into variants; '#include "<file>"' lines are replaced
+  // by the file from the shader's directory
+  static Shader fromFile(const char* filename, GLenum shaderType, std::initializer_list<const char*> defines = {});
 
 }; // class Shader
 
@@ -34,35 +41,42 @@ class VertexShader
 {
 public:
   static Shader fromMemory(const char* data) { return Shader::fromMemory(data, GL_VERTEX_SHADER); }
-  static Shader fromFile(const char* filename) { return Shader::fromFile(filename, GL_VERTEX_SHADER); }
+  static Shader fromFile(const char* filename, std::initializer_list<const char*> defines = {}) { return Shader::fromFile(filename, GL_VERTEX_SHADER, defines); }
 };
 
 class TessellationControlShader
 {
 public:
   static Shader fromMemory(const char* data) { return Shader::fromMemory(data, GL_TESS_CONTROL_SHADER); }
-  static Shader fromFile(const char* filename) { return Shader::fromFile(filename, GL_TESS_CONTROL_SHADER); }
+  static Shader fromFile(const char* filename, std::initializer_list<const char*> defines = {}) { return Shader::fromFile(filename, GL_TESS_CONTROL_SHADER, defines); }
 };
 
 class TessellationEvaluationShader
 {
 public:
   static Shader fromMemory(const char* data) { return Shader::fromMemory(data, GL_TESS_EVALUATION_SHADER); }
-  static Shader fromFile(const char* filename) { return Shader::fromFile(filename, GL_TESS_EVALUATION_SHADER); }
+  static Shader fromFile(const char* filename, std::initializer_list<const char*> defines = {}) { return Shader::fromFile(filename, GL_TESS_EVALUATION_SHADER, defines); }
 };
 
 class GeometryShader
 {
 public:
   static Shader fromMemory(const char* data) { return Shader::fromMemory(data, GL_GEOMETRY_SHADER); }
-  static Shader fromFile(const char* filename) { return Shader::fromFile(filename, GL_GEOMETRY_SHADER); }
+  static Shader fromFile(const char* filename, std::initializer_list<const char*> defines = {}) { return Shader::fromFile(filename, GL_GEOMETRY_SHADER, defines); }
 };
 
 class FragmentShader
 {
 public:
   static Shader fromMemory(const char* data) { return Shader::fromMemory(data, GL_FRAGMENT_SHADER); }
-  static Shader fromFile(const char* filename) { return Shader::fromFile(filename, GL_FRAGMENT_SHADER); }
+  static Shader fromFile(const char* filename, std::initializer_list<const char*> defines = {}) { return Shader::fromFile(filename, GL_FRAGMENT_SHADER, defines); }
+};
+
+class ComputeShader
+{
+public:
+  static Shader fromMemory(const char* data) { return Shader::fromMemory(data, GL_COMPUTE_SHADER); }
+  static Shader fromFile(const char* filename, std::initializer_list<const char*> defines = {}) { return Shader::fromFile(filename, GL_COMPUTE_SHADER, defines); }
 };
 
 #endif // !WILT_SHADER_H
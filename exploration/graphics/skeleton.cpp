@@ -0,0 +1,119 @@
+#include "skeleton.h"
+
+#include <algorithm>
+#include <string>
+
+#include "../logging/LoggingManager.h"
+
+namespace { auto logger = wilt::logging.createLogger("graphics-skeleton"); }
+
+std::size_t Skeleton::size() const
+{
+  return _joints.size();
+}
+
+bool Skeleton::empty() const
+{
+  return _joints.empty();
+}
+
+const std::vector<int>& Skeleton::joints() const
+{
+  return _joints;
+}
+
+const std::vector<int>& Skeleton::parents() const
+{
+  return _parents;
+}
+
+const std::vector<glm::mat4>& Skeleton::locals() const
+{
+  return _locals;
+}
+
+const std::vector<glm::mat4>& Skeleton::binds() const
+{
+  return _binds;
+}
+
+const std::vector<glm::mat4>& Skeleton::inverseBinds() const
+{
+  return _inverseBinds;
+}
+
+void Skeleton::pose(const JointPose* poses1, const JointPose* poses2, float interp, glm::mat4* transforms) const
+{
+  // posed model space transform of each sorted joint, parents are always
+  // filled in before their children need them
+  glm::mat4 posed[MAX_JOINTS];
+
+  for (std::size_t i = 0; i < _joints.size(); ++i)
+  {
+    auto joint = _joints[i];
+    auto parent = _parents[i];
+
+    auto local = _locals[i] * JointPose::interpolate(poses1[joint], poses2[joint], interp).calcLocalTransform();
+    posed[i] = parent != -1 ? posed[parent] * local : local;
+    transforms[joint] = posed[i] * _inverseBinds[i];
+  }
+}
+
+Skeleton Skeleton::bake(const std::vector<Joint>& joints)
+{
+  auto skeleton = Skeleton{};
+  auto count = (int)joints.size();
+  if (count > MAX_JOINTS)
+  {
+    logger.error("skeleton has " + std::to_string(count) + " joints, only " + std::to_string(MAX_JOINTS) + " can be skinned");
+    return skeleton;
+  }
+
+  // sweeps the joints in order placing each once its parent is, so skeletons
+  // that are already sorted (like the exporter's) keep their order
+  auto sorted = std::vector<int>(count, -1);
+  auto place = [&](int joint, int parent) {
+    sorted[joint] = (int)skeleton._joints.size();
+    skeleton._joints.push_back(joint);
+    skeleton._parents.push_back(parent);
+  };
+
+  while ((int)skeleton._joints.size() < count)
+  {
+    auto placed = false;
+    for (int i = 0; i < count; ++i)
+    {
+      if (sorted[i] != -1)
+        continue;
+
+      auto parent = joints[i].parentIndex();
+      if (parent < 0 || parent >= count)
+        place(i, -1);
+      else if (sorted[parent] != -1)
+        place(i, sorted[parent]);
+      else
+        continue;
+
+      placed = true;
+    }
+
+    // the joints left only lead back to each other, break the loop
+    if (!placed)
+      place((int)(std::find(sorted.begin(), sorted.end(), -1) - sorted.begin()), -1);
+  }
+
+  skeleton._locals.resize(count);
+  skeleton._binds.resize(count);
+  skeleton._inverseBinds.resize(count);
+  for (int i = 0; i < count; ++i)
+  {
+    auto& local = joints[skeleton._joints[i]].transform();
+    auto parent = skeleton._parents[i];
+
+    skeleton._locals[i] = local;
+    skeleton._binds[i] = parent != -1 ? skeleton._binds[parent] * local : local;
+    skeleton._inverseBinds[i] = glm::inverse(skeleton._binds[i]);
+  }
+
+  return skeleton;
+}
@@ -0,0 +1,48 @@
+#ifndef WILT_SKELETON_H
+#define WILT_SKELETON_H
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "joint.h"
+#include "jointPose.h"
+
+// A model's joints baked for posing. The joints are sorted so every parent
+// comes before its children and the bind pose and its inverse are worked out
+// once, so posing is a single pass over the arrays. Poses and transforms are
+// still indexed by the model's joint order, which the vertices use.
+class Skeleton
+{
+private:
+  std::vector<int> _joints; // the model's index for each sorted joint
+  std::vector<int> _parents; // sorted index of the parent, -1 for roots
+  std::vector<glm::mat4> _locals; // bind transform relative to the parent
+  std::vector<glm::mat4> _binds;
+  std::vector<glm::mat4> _inverseBinds;
+
+public:
+  Skeleton() = default;
+
+public:
+  std::size_t size() const;
+  bool empty() const;
+
+  const std::vector<int>& joints() const;
+  const std::vector<int>& parents() const;
+  const std::vector<glm::mat4>& locals() const;
+  const std::vector<glm::mat4>& binds() const;
+  const std::vector<glm::mat4>& inverseBinds() const;
+
+  // writes the skinning transform of every joint, blending each joint's pose
+  // from poses1 towards poses2, both with one pose per joint
+  void pose(const JointPose* poses1, const JointPose* poses2, float interp, glm::mat4* transforms) const;
+
+public:
+  // skeletons larger than MAX_JOINTS can't be skinned and bake empty
+  static Skeleton bake(const std::vector<Joint>& joints);
+
+}; // class Skeleton
+
+#endif // !WILT_SKELETON_H
@@ -0,0 +1,187 @@
+#include "vertexLayout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+namespace
+{
+  // 10 floats per vertex (x, y, z, g1, g2, g3, w1, w2, w3, o)
+  const std::size_t FULL_STRIDE = 10;
+
+  // how far, in model units, packing may move a vertex
+  const float TOLERANCE = 1.0f / 256.0f;
+
+  struct CompactVertex
+  {
+    float position[3];
+    std::uint16_t order;
+    std::uint8_t groups[3];
+    std::uint8_t padding;
+    std::uint16_t weights[3];
+  };
+  static_assert(sizeof(CompactVertex) == 24, "unexpected CompactVertex padding");
+
+  struct QuantizedVertex
+  {
+    std::uint16_t position[3];
+    std::uint16_t order;
+    std::uint8_t groups[3];
+    std::uint8_t weights[3];
+    std::uint8_t padding[2];
+  };
+  static_assert(sizeof(QuantizedVertex) == 16, "unexpected QuantizedVertex padding");
+
+  bool packable(const float* vertex)
+  {
+    for (int i = 3; i < 6; ++i)
+    {
+      if (!(vertex[i] >= 0.0f && vertex[i] <= 255.0f) || vertex[i] != std::floor(vertex[i]))
+        return false;
+    }
+    for (int i = 6; i < 10; ++i)
+    {
+      if (!(vertex[i] >= 0.0f && vertex[i] <= 1.0f))
+        return false;
+    }
+    return true;
+  }
+
+  // estimates how far the vertex moves once packed: position rounding plus
+  // the weight rounding scaled by the distance from the joint origin
+  float packingError(const float* vertex, VertexLayout layout)
+  {
+    auto position = glm::vec3(vertex[0], vertex[1], vertex[2]);
+
+    auto positionError = 0.0f;
+    auto weightError = 0.0f;
+    for (int i = 0; i < 3; ++i)
+    {
+      if (layout == VertexLayout::Quantized)
+      {
+        positionError = std::max(positionError, std::abs(glm::unpackHalf1x16(glm::packHalf1x16(vertex[i])) - vertex[i]));
+        weightError += std::abs(glm::unpackUnorm1x8(glm::packUnorm1x8(vertex[6 + i])) - vertex[6 + i]);
+      }
+      else
+      {
+        weightError += std::abs(glm::unpackUnorm1x16(glm::packUnorm1x16(vertex[6 + i])) - vertex[6 + i]);
+      }
+    }
+
+    // NaN (e.g. from an overflowing half) must not pass
+    auto error = positionError + weightError * glm::length(position);
+    return std::isfinite(error) ? error : TOLERANCE * 2;
+  }
+}
+
+std::size_t vertexStride(VertexLayout layout)
+{
+  switch (layout)
+  {
+  case VertexLayout::Compact: return sizeof(CompactVertex);
+  case VertexLayout::Quantized: return sizeof(QuantizedVertex);
+  default: return FULL_STRIDE * sizeof(float);
+  }
+}
+
+VertexLayout chooseVertexLayout(ArrayView<const float> vertices, VertexLayout mostCompact)
+{
+  if (mostCompact == VertexLayout::Full)
+    return VertexLayout::Full;
+
+  auto quantized = mostCompact == VertexLayout::Quantized;
+  for (std::size_t i = 0; i < vertices.size(); i += FULL_STRIDE)
+  {
+    auto vertex = &vertices[i];
+    if (!packable(vertex))
+      return VertexLayout::Full;
+
+    if (packingError(vertex, VertexLayout::Compact) > TOLERANCE)
+      return VertexLayout::Full;
+    if (quantized && packingError(vertex, VertexLayout::Quantized) > TOLERANCE)
+      quantized = false;
+  }
+
+  return quantized ? VertexLayout::Quantized : VertexLayout::Compact;
+}
+
+ArrayView<const unsigned char> packVertices(ArrayView<const float> vertices, VertexLayout layout, std::vector<unsigned char>& storage)
+{
+  if (layout == VertexLayout::Full)
+    return ArrayView<const unsigned char>((const unsigned char*)vertices.data(), vertices.bytes());
+
+  auto count = vertices.size() / FULL_STRIDE;
+  storage.resize(count * vertexStride(layout));
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    auto vertex = &vertices[i * FULL_STRIDE];
+
+    if (layout == VertexLayout::Compact)
+    {
+      CompactVertex packed{};
+      std::memcpy(packed.position, vertex, sizeof(packed.position));
+      packed.order = glm::packUnorm1x16(vertex[9]);
+      for (int j = 0; j < 3; ++j)
+      {
+        packed.groups[j] = (std::uint8_t)vertex[3 + j];
+        packed.weights[j] = glm::packUnorm1x16(vertex[6 + j]);
+      }
+      std::memcpy(&storage[i * sizeof(packed)], &packed, sizeof(packed));
+    }
+    else
+    {
+      QuantizedVertex packed{};
+      packed.order = glm::packUnorm1x16(vertex[9]);
+      for (int j = 0; j < 3; ++j)
+      {
+        packed.position[j] = glm::packHalf1x16(vertex[j]);
+        packed.groups[j] = (std::uint8_t)vertex[3 + j];
+        packed.weights[j] = glm::packUnorm1x8(vertex[6 + j]);
+      }
+      std::memcpy(&storage[i * sizeof(packed)], &packed, sizeof(packed));
+    }
+  }
+
+  return storage;
+}
+
+void setVertexFormat(GLuint vertexArray, VertexLayout layout)
+{
+  for (GLuint attribute = 0; attribute < 4; ++attribute)
+  {
+    glEnableVertexArrayAttrib(vertexArray, attribute);
+    glVertexArrayAttribBinding(vertexArray, attribute, 0);
+  }
+
+  switch (layout)
+  {
+  case VertexLayout::Full:
+    glVertexArrayAttribFormat(vertexArray, 0, 3, GL_FLOAT, GL_FALSE, 0);
+    glVertexArrayAttribFormat(vertexArray, 1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float));
+    glVertexArrayAttribFormat(vertexArray, 2, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float));
+    glVertexArrayAttribFormat(vertexArray, 3, 1, GL_FLOAT, GL_FALSE, 9 * sizeof(float));
+    break;
+
+  // groups are not normalized so they arrive as whole numbers, like before
+  case VertexLayout::Compact:
+    glVertexArrayAttribFormat(vertexArray, 0, 3, GL_FLOAT, GL_FALSE, offsetof(CompactVertex, position));
+    glVertexArrayAttribFormat(vertexArray, 1, 3, GL_UNSIGNED_BYTE, GL_FALSE, offsetof(CompactVertex, groups));
+    glVertexArrayAttribFormat(vertexArray, 2, 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(CompactVertex, weights));
+    glVertexArrayAttribFormat(vertexArray, 3, 1, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(CompactVertex, order));
+    break;
+
+  case VertexLayout::Quantized:
+    glVertexArrayAttribFormat(vertexArray, 0, 3, GL_HALF_FLOAT, GL_FALSE, offsetof(QuantizedVertex, position));
+    glVertexArrayAttribFormat(vertexArray, 1, 3, GL_UNSIGNED_BYTE, GL_FALSE, offsetof(QuantizedVertex, groups));
+    glVertexArrayAttribFormat(vertexArray, 2, 3, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(QuantizedVertex, weights));
+    glVertexArrayAttribFormat(vertexArray, 3, 1, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(QuantizedVertex, order));
+    break;
+  }
+}
@@ -0,0 +1,45 @@
+#ifndef WILT_VERTEXLAYOUT_H
+#define WILT_VERTEXLAYOUT_H
+
+#include <cstddef>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "../utilities/arrayView.h"
+
+// How a model's vertices are stored in its vertex buffer. The shaders see the
+// same attributes regardless (vec3 position, groups and weights and a float
+// order), the packed layouts just leave the conversion to the vertex fetch:
+//
+//   Full       10 floats                                      40 bytes
+//   Compact    float position, unorm16 order, uint8 groups,
+//              unorm16 weights                                24 bytes
+//   Quantized  half position, unorm16 order, uint8 groups,
+//              unorm8 weights                                 16 bytes
+//
+// The vertices on the CPU side (physics, deformation) are always Full.
+enum class VertexLayout
+{
+  Full,
+  Compact,
+  Quantized,
+};
+
+const std::size_t VERTEX_LAYOUT_COUNT = 3;
+
+std::size_t vertexStride(VertexLayout layout);
+
+// Picks the most compact layout, no more compact than the one given, that
+// keeps every vertex within a small distance of where it would be otherwise.
+VertexLayout chooseVertexLayout(ArrayView<const float> vertices, VertexLayout mostCompact);
+
+// Converts vertices to the layout, using storage if needed. Full vertices are
+// returned as they are.
+ArrayView<const unsigned char> packVertices(ArrayView<const float> vertices, VertexLayout layout, std::vector<unsigned char>& storage);
+
+// Sets up the attributes of a vertex array to read the layout from whatever
+// buffer is attached to its binding 0.
+void setVertexFormat(GLuint vertexArray, VertexLayout layout);
+
+#endif // !WILT_VERTEXLAYOUT_H
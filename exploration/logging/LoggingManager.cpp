@@ -30,6 +30,7 @@ void LoggingManager::log(LoggingLevel level, const char* source, const std::stri
   auto time = high_resolution_clock::now().time_since_epoch();
   auto ns = duration_cast<nanoseconds>(time).count();
 
+  std::lock_guard<std::mutex> lock(mutex);
   logger->log(level, source, message.c_str(), ns);
 }
 
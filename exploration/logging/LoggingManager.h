@@ -8,6 +8,7 @@
 #define WILT_LOGGINGMANAGER_H
 
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <string>
 
@@ -47,6 +48,7 @@ namespace wilt
   private:
     std::unique_ptr<ILogger> logger;
     LoggingLevel level;
+    std::mutex mutex; // models are read on worker threads
 
   }; // class LoggingManager
 
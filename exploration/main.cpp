@@ -19,30 +19,45 @@
 #include <map>
 #include <cmath>
 #include <iomanip>
+#include <filesystem>
 
+#include "AnimationClip.h"
 #include "Model.h"
 #include "DecorationModel.h"
 #include "GameState.h"
+#include "ModelInstances.h"
 #include "EntitySpawnInfo.h"
 #include "EntityType.h"
 #include "InputManager.h"
 #include "logging/LoggingManager.h"
 #include "logging/loggers/StreamLogger.h"
 #include "graphics/program.h"
+#include "graphics/debugOutput.h"
+#include "graphics/depthPyramid.h"
+#include "graphics/depthResolve.h"
 #include "graphics/programs/DepthProgram.h"
 #include "graphics/programs/LineProgram.h"
 #include "graphics/programs/DebugProgram.h"
 #include "graphics/programs/ScreenProgram.h"
 #include "graphics/texture.h"
 #include "graphics/framebuffer.h"
+#include "graphics/frameUniforms.h"
+#include "graphics/frustum.h"
 #include "graphics/joint.h"
+#include "graphics/jointPalette.h"
 #include "graphics/jointPose.h"
 #include "graphics/IAnimator.h"
+#include "graphics/modelBuffers.h"
+#include "utilities/fileWatcher.h"
+#include "utilities/textReader.h"
+#include "utilities/workerPool.h"
 #include "cameras/FollowCamera.h"
 #include "cameras/TrackCamera.h"
 #include "cameras/FreeCamera.h"
 #include "cameras/IdleCamera.h"
+#include "entities/AnimationSystem.h"
 #include "entities/Entity.h"
+#include "entities/EntityTree.h"
 #include "entities/PlayerEntity.h"
 #include "entities/SpiritEntity.h"
 #include "entities/DecorationEntity.h"
@@ -65,93 +80,70 @@ Framebuffer debgFramebuffer;
 
 InputManager* globalInputManager = nullptr;
 
-struct AnimationFrame
-{
-  std::vector<JointPose> _poses;
-};
-
-struct Animation
-{
-  std::vector<AnimationFrame> _frames;
-};
-
 class StaticAnimator : public IAnimator
 {
 public:
-  void applyAnimation(Program& program, float time, std::vector<Joint>& joints) override
+  void applyAnimation(float time, const Skeleton& skeleton, glm::mat4* transforms) override
   {
-    glm::mat4 jointTransforms[MAX_JOINTS];
-    glUniformMatrix4fv(glGetUniformLocation(program.id(), "positions"), MAX_JOINTS, false, glm::value_ptr(jointTransforms[0]));
+    std::fill(transforms, transforms + skeleton.size(), glm::mat4());
   }
 };
 
 class LoopAnimator : public IAnimator
 {
 public:
-  Animation animation;
+  AnimationClip clip;
   float framesPerSecond;
 
 public:
-  LoopAnimator(Animation animation, float fps = 24.0f)
-    : animation{ animation }
+  LoopAnimator(AnimationClip clip, float fps = 24.0f)
+    : clip{ std::move(clip) }
     , framesPerSecond{ fps }
   { }
 
 public:
-  void applyAnimation(Program& program, float time, std::vector<Joint>& joints) override
+  void applyAnimation(float time, const Skeleton& skeleton, glm::mat4* transforms) override
   {
-    float frame_pos = std::fmod(time * framesPerSecond, animation._frames.size());
+    // a clip made for another skeleton leaves the joints where they are
+    if (!clip.loaded() || clip.frameCount() == 0 || clip.jointCount() < skeleton.size() || clip.jointCount() > MAX_JOINTS)
+      return;
+
+    float frame_pos = std::fmod(time * framesPerSecond, clip.frameCount());
     int frame1 = (int)frame_pos;
-    int frame2 = (frame1 + 1) % animation._frames.size();
+    int frame2 = (frame1 + 1) % clip.frameCount();
     float interlop = frame_pos - frame1;
 
-    std::vector<glm::mat4> animatedTransforms(animation._frames[0]._poses.size());
-    std::vector<glm::mat4> forwardTransforms(animation._frames[0]._poses.size());
-    std::vector<glm::mat4> backwardTransforms(animation._frames[0]._poses.size());
+    JointPose poses1[MAX_JOINTS];
+    JointPose poses2[MAX_JOINTS];
+    clip.decode(frame1, poses1);
+    clip.decode(frame2, poses2);
 
-    for (int i = 0; i < animation._frames[0]._poses.size(); ++i)
-    {
-      auto p = joints[i].parentIndex();
-      auto forward = (p != -1) ? forwardTransforms[p] : glm::mat4();
-      auto backward = (p != -1) ? backwardTransforms[p] : glm::mat4();
-
-      JointPose interpolatedJointPose = JointPose::interpolate(animation._frames[frame1]._poses[i], animation._frames[frame2]._poses[i], interlop);
-      glm::mat4 interpolatedTransform = interpolatedJointPose.calcLocalTransform();
-      forwardTransforms[i] = forward * joints[i].transform() * interpolatedTransform;
-      backwardTransforms[i] = glm::inverse(joints[i].transform()) * backward;
-      animatedTransforms[i] = forwardTransforms[i] * backwardTransforms[i];
-    }
-
-    glUniformMatrix4fv(glGetUniformLocation(program.id(), "positions"), animatedTransforms.size(), false, glm::value_ptr(animatedTransforms[0]));
+    skeleton.pose(poses1, poses2, interlop, transforms);
   }
 };
 
-Animation read_animation(std::string path)
+AnimationClip read_animation(std::string path)
 {
-  std::ifstream file(path);
-  unsigned int frameCount;
-  unsigned int boneCount;
-
-  file >> frameCount >> boneCount;
-  Animation ret;
-  ret._frames = std::vector<AnimationFrame>{ frameCount, AnimationFrame{ std::vector<JointPose>{ boneCount } } };
-
-  for (int i = 0; i < frameCount; ++i)
+  // prefer the converted clip unless the text file has been edited since it
+  // was converted, like EntityType does for models
+  auto fileError = std::error_code();
+  auto fileTime = std::filesystem::last_write_time(path, fileError);
+  auto binaryPath = std::filesystem::path(path).replace_extension(".bin");
+  auto binaryError = std::error_code();
+  auto binaryTime = std::filesystem::last_write_time(binaryPath, binaryError);
+  if (!fileError && !binaryError && binaryTime >= fileTime)
   {
-    for (int j = 0; j < boneCount; ++j)
-    {
-      file >> ret._frames[i]._poses[j].location[0];
-      file >> ret._frames[i]._poses[j].location[1];
-      file >> ret._frames[i]._poses[j].location[2];
-
-      file >> ret._frames[i]._poses[j].rotation[3]; // w
-      file >> ret._frames[i]._poses[j].rotation[0]; // x
-      file >> ret._frames[i]._poses[j].rotation[1]; // y
-      file >> ret._frames[i]._poses[j].rotation[2]; // z
-    }
+    auto clip = AnimationClip::fromFile(binaryPath.string());
+    if (clip.loaded())
+      return clip;
   }
 
-  return ret;
+  auto file = TextReader::fromFile(path);
+  auto frames = std::vector<std::vector<JointPose>>();
+  if (!file || !AnimationClip::readFrames(file, frames))
+    return AnimationClip{};
+
+  return AnimationClip::encode(frames);
 }
 
 class Level
@@ -163,7 +155,7 @@ public:
   {
     Level level;
 
-    std::ifstream file(filename);
+    auto file = TextReader::fromFile(filename);
     if (!file)
       return level;
 
@@ -201,49 +193,6 @@ public:
   }
 };
 
-void logError(const std::string &name)
-{
-  auto error = glGetError();
-  if (error == GL_NO_ERROR)
-    return;
-
-  switch (error)
-  {
-  case GL_INVALID_ENUM:
-    logger.error("GL_INVALID_ENUM");
-    logger.error(name);
-    break;
-  case GL_INVALID_VALUE:
-    logger.error("GL_INVALID_VALUE");
-    logger.error(name);
-    break;
-  case GL_INVALID_OPERATION:
-    logger.error("GL_INVALID_OPERATION");
-    logger.error(name);
-    break;
-  case GL_INVALID_FRAMEBUFFER_OPERATION:
-    logger.error("GL_INVALID_FRAMEBUFFER_OPERATION");
-    logger.error(name);
-    break;
-  case GL_OUT_OF_MEMORY:
-    logger.error("GL_OUT_OF_MEMORY");
-    logger.error(name);
-    break;
-  case GL_STACK_UNDERFLOW:
-    logger.error("GL_STACK_UNDERFLOW");
-    logger.error(name);
-    break;
-  case GL_STACK_OVERFLOW:
-    logger.error("GL_STACK_OVERFLOW");
-    logger.error(name);
-    break;
-  default:
-    logger.error("UNKNOWN");
-    logger.error(name);
-    break;
-  }
-}
-
 btRigidBody* createTestBoxBody(glm::vec3 position, glm::vec3 rotation)
 {
   auto boxTransform = btTransform();
@@ -271,8 +220,17 @@ public:
   { }
 };
 
-int main()
+int main(int argc, char* argv[])
 {
+  // driver errors and warnings are logged as they happen with --gl-debug,
+  // otherwise nothing checks for them
+  auto debugOutput = false;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::string(argv[i]) == "--gl-debug")
+      debugOutput = true;
+  }
+
   wilt::logging.setLogger<wilt::StreamLogger>(std::cout);
   wilt::logging.setLevel(wilt::LoggingLevel::DEBUG);
 
@@ -280,6 +238,7 @@ int main()
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
+  glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, debugOutput ? GL_TRUE : GL_FALSE);
 
 #ifdef __APPLE__
   glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); // uncomment this statement to fix compilation on OS X
@@ -302,6 +261,9 @@ int main()
     return -1;
   }
 
+  if (debugOutput)
+    enableDebugOutput();
+
   glEnable(GL_DEPTH_TEST);
 
   LineProgram lineProgram{
@@ -309,12 +271,20 @@ int main()
     TessellationControlShader::fromFile("shaders/line.tesc.glsl"),
     TessellationEvaluationShader::fromFile("shaders/line.tess.glsl"),
     GeometryShader::fromFile("shaders/line.geom.glsl"),
-    FragmentShader::fromFile("shaders/line.frag.glsl")
+    FragmentShader::fromFile("shaders/line.frag.glsl"),
+    VertexShader::fromFile("shaders/line.vert.glsl", { "UNSKINNED" }),
+    TessellationControlShader::fromFile("shaders/line.tesc.glsl", { "UNSKINNED" }),
+    TessellationEvaluationShader::fromFile("shaders/line.tess.glsl", { "UNSKINNED" }),
+    GeometryShader::fromFile("shaders/line.geom.glsl", { "UNSKINNED" }),
+    FragmentShader::fromFile("shaders/line.frag.glsl", { "UNSKINNED" })
   };
   DepthProgram depthProgram{
     VertexShader::fromFile("shaders/depth.vert.glsl"),
     GeometryShader::fromFile("shaders/depth.geom.glsl"),
-    FragmentShader::fromFile("shaders/depth.frag.glsl")
+    FragmentShader::fromFile("shaders/depth.frag.glsl"),
+    VertexShader::fromFile("shaders/depth.vert.glsl", { "UNSKINNED" }),
+    GeometryShader::fromFile("shaders/depth.geom.glsl", { "UNSKINNED" }),
+    FragmentShader::fromFile("shaders/depth.frag.glsl", { "UNSKINNED" })
   };
   DebugProgram debugProgram{
     VertexShader::fromFile("shaders/debug.vert.glsl"),
@@ -324,11 +294,13 @@ int main()
     VertexShader::fromFile("shaders/screen.vert.glsl"),
     FragmentShader::fromFile("shaders/screen.frag.glsl")
   };
+  DepthResolve depthResolve{ ComputeShader::fromFile("shaders/resolve.comp.glsl") };
 
   if (lineProgram.id()   == 0 ||
       depthProgram.id()  == 0 ||
       debugProgram.id()  == 0 ||
-      screenProgram.id() == 0)
+      screenProgram.id() == 0 ||
+      !depthResolve.loaded())
   {
     std::cin.get();
     return -1;
@@ -345,6 +317,11 @@ int main()
     Texture::fromMemory(NULL, GL_RGB, SCR_WIDTH, SCR_HEIGHT)
   );
 
+  FrameUniformBuffer frameUniforms;
+  JointPalette jointPalette;
+  AnimationSystem animationSystem{ 1.0f / 144.0f };
+  DepthPyramid depthPyramid{ ComputeShader::fromFile("shaders/pyramid.comp.glsl") };
+
   Texture paperTexture = Texture::fromFile("models/paper_texture.jpg");
   paperTexture.setMinFilter(GL_LINEAR);
   paperTexture.setMagFilter(GL_LINEAR);
@@ -369,8 +346,15 @@ int main()
   entityTypes["floatingisland"] = new EntityType<TerrainEntity, Model>{ "models/floatingisland_model.txt" };
   entityTypes["level_1"]        = new EntityType<TerrainEntity, Model>{ "models/level_1_model.txt" };
   entityTypes["temp"]           = new EntityType<Entity, DecorationModel>{ "models/temp_model.txt" };
-  for (auto& [name, type] : entityTypes)
-    type->read();
+
+  // parsing is independent per type so it is spread over the workers; only
+  // the GL upload in load() below has to happen on this thread
+  {
+    auto workers = WorkerPool{};
+    for (auto& [name, type] : entityTypes)
+      workers.submit([type = type] { type->read(); });
+    workers.wait();
+  }
 
   //level.entities.push_back({ "testbox", { 0, 0, 1 }, { 0, 0, 0 }, { 1, 1, 1 } });
   //level.entities.push_back({ "testbox", { 4, 1, 1 }, { 0, 0, 0 }, { 1, 1, 1 } });
@@ -529,19 +513,39 @@ int main()
       globalInputManager->setKeyState(key, action);
   });
 
-  auto gameState = GameState{ &inputManager, dynamicsWorld, terrainShape, followCam, player->position, entityTypes, entities, lineProgram };
+  auto modelInstances = ModelInstances();
+  auto entityTree = EntityTree();
+  auto gameState = GameState{ &inputManager, dynamicsWorld, terrainShape, followCam, player->position, entityTypes, entities, lineProgram, modelInstances, entityTree };
 
   auto maxFPS = 0.0f;
   auto minFPS = 1000.0f;
   auto totFPS = 0.0f;
 
+  // entities in view this frame and those of them not hidden behind the
+  // faces, and how many were drawn, culled and occluded over the frames since
+  // the last report
+  auto visibleEntities = std::vector<Entity*>();
+  auto unoccludedEntities = std::vector<Entity*>();
+  auto totDrawn = std::size_t(0);
+  auto totCulled = std::size_t(0);
+  auto totOccluded = std::size_t(0);
+  auto totAnimated = std::size_t(0);
+
   auto lastFrameTime = std::chrono::high_resolution_clock::now();
   auto currFrameTime = std::chrono::high_resolution_clock::now();
 
   auto debugViewEnabled = false;
 
-  auto fileCheckInterval = std::chrono::seconds(2);
-  auto lastFileCheckTime = std::chrono::high_resolution_clock::now();
+  // changed models are parsed on the watcher thread and swapped in at the
+  // start of a frame
+  auto modelWatcher = FileWatcher{ { "models" }, [&entityTypes](const std::filesystem::path& path)
+  {
+    for (auto& [name, type] : entityTypes)
+    {
+      if (type->dependsOn(path))
+        type->prepareReload();
+    }
+  } };
 
   while (!glfwWindowShouldClose(window))
   {
@@ -549,12 +553,8 @@ int main()
     lastFrameTime = currFrameTime;
     currFrameTime = std::chrono::high_resolution_clock::now();
 
-    if (lastFileCheckTime + fileCheckInterval < currFrameTime)
-    {
-      for (auto&[name, type] : entityTypes)
-        type->reload();
-      lastFileCheckTime = currFrameTime;
-    }
+    for (auto&[name, type] : entityTypes)
+      type->finishReload();
 
     // input
     inputManager.update();
@@ -575,11 +575,19 @@ int main()
     if (i % 144 == 143)
     {
       std::cout << " avg: " << std::setw(7) << std::left << totFPS / 144;
-      std::cout << " min: " << std::setw(7) << std::left << minFPS << std::endl;
+      std::cout << " min: " << std::setw(7) << std::left << minFPS;
+      std::cout << " drawn: " << std::setw(5) << std::left << totDrawn / 144;
+      std::cout << " culled: " << std::setw(5) << std::left << totCulled / 144;
+      std::cout << " occluded: " << std::setw(5) << std::left << totOccluded / 144;
+      std::cout << " animated: " << std::setw(5) << std::left << totAnimated / 144 << std::endl;
 
       maxFPS = 0.0f;
       minFPS = 1000.0f;
       totFPS = 0.0f;
+      totDrawn = 0;
+      totCulled = 0;
+      totOccluded = 0;
+      totAnimated = 0;
     }
 
     if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
@@ -640,7 +648,11 @@ int main()
 
       // entity management
       for (auto& entity : gameState.removeList)
+      {
         entities.erase(std::find(entities.begin(), entities.end(), entity));
+        entityTree.remove(entity);
+        delete entity; // frees its transform slots for the next entity
+      }
       gameState.removeList.clear();
 
       for (auto& entity : gameState.addList)
@@ -648,9 +660,28 @@ int main()
       gameState.addList.clear();
     }
 
+    for (auto& entity : entities)
+      entity->updateTransforms();
+    EntityTransforms::shared.build();
+
+    // only entities that moved out of the room their leaf gives them are
+    // reinserted
+    for (auto& entity : entities)
+      entityTree.update(entity);
+
     glm::mat4 view = cam->getTransform();
     glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
 
+    { // culling, entities outside the view are skipped by both passes
+      auto frustum = Frustum(projection * view);
+
+      visibleEntities.clear();
+      entityTree.queryFrustum(frustum, visibleEntities);
+
+      totDrawn += visibleEntities.size();
+      totCulled += entities.size() - visibleEntities.size();
+    }
+
     if (!paused)
     {
       if (i % 144 == 0)
@@ -662,52 +693,76 @@ int main()
       i++;
     }
 
+    { // per-frame uniforms, shared by every program
+      FrameUniforms uniforms;
+      uniforms.projection = projection;
+      uniforms.view = view;
+      uniforms.referenceProjection = reference_projection;
+      uniforms.referenceView = reference_view;
+      uniforms.viewReference = view_reference;
+      uniforms.ratio = (float)SCR_WIDTH / (float)SCR_HEIGHT;
+      uniforms.cameraPosition = cam->getPosition();
+      uniforms.viewportWidth = SCR_WIDTH;
+      uniforms.baseCameraDirection = cam->getDirection();
+      uniforms.viewportHeight = SCR_HEIGHT;
+      frameUniforms.update(uniforms);
+    }
+
+    { // joints, posed once and shared by both passes
+      jointPalette.clear();
+      totAnimated += animationSystem.pose(visibleEntities, cam->getPosition(), time, jointPalette);
+      jointPalette.upload();
+    }
+
     { // render depth
       depthProgram.use();
-      depthProgram.setProjection(projection);
-      depthProgram.setView(view);
-      depthProgram.setReferenceProjection(reference_projection);
-      depthProgram.setReferenceView(reference_view);
-      depthProgram.setRatio((float)SCR_WIDTH / (float)SCR_HEIGHT);
       depthProgram.setFrame(i / 144);
-      depthProgram.setViewReference(view_reference);
-      depthProgram.setVec3("base_camera_direction", cam->getDirection());
-      depthProgram.setFloat("viewport_width", SCR_WIDTH);
-      depthProgram.setFloat("viewport_height", SCR_HEIGHT);
 
       int code = ((zcode & 0x07) << 5) | ((xcode & 0x03) << 3) | ((ycode & 0x07) << 0);
-      depthProgram.setInt("code", code);
+      depthProgram.setCode(code);
 
       glBindFramebuffer(GL_FRAMEBUFFER, faceFramebuffer.id());
       glEnable(GL_DEPTH_TEST);
       glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
       glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-      for (auto& entity : entities)
+      for (auto& entity : visibleEntities)
         entity->draw_faces(gameState, depthProgram, time);
+      modelInstances.draw_faces(depthProgram);
 
-      glBindVertexArray(0);
+      ModelBuffers::shared.unbind();
       glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
+    { // occlusion, entities hidden behind the faces skip the line pass
+      depthResolve.resolve(faceFramebuffer.depthTexture(), SCR_WIDTH, SCR_HEIGHT);
+      depthPyramid.build(depthResolve.texture(), SCR_WIDTH, SCR_HEIGHT, projection * view);
+
+      unoccludedEntities.clear();
+      for (auto& entity : visibleEntities)
+      {
+        if (!depthPyramid.occluded(entity->bounds()))
+          unoccludedEntities.push_back(entity);
+      }
+
+      totOccluded += visibleEntities.size() - unoccludedEntities.size();
+    }
+
     { // render lines
       lineProgram.use();
-      lineProgram.setProjection(projection);
-      lineProgram.setView(view);
       lineProgram.setFrame(i / 24);
-      lineProgram.setRatio((float)SCR_WIDTH / (float)SCR_HEIGHT);
-      lineProgram.setViewReference(view_reference);
-      lineProgram.setCameraPosition(cam->getPosition());
-      lineProgram.setDepthTexture(faceFramebuffer.depthTexture());
+      lineProgram.setDepthTexture(depthResolve.texture());
 
       glBindFramebuffer(GL_FRAMEBUFFER, lineFramebuffer.id());
       glEnable(GL_DEPTH_TEST);
       glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
       glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-      for (auto& entity : entities)
+      for (auto& entity : unoccludedEntities)
         entity->draw_lines(gameState, lineProgram, time);
+      modelInstances.draw_lines(lineProgram);
 
+      ModelBuffers::shared.unbind();
       glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
       lineProgram.reset();
@@ -715,8 +770,6 @@ int main()
 
     { // render debug
       debugProgram.use();
-      debugProgram.setProjection(projection);
-      debugProgram.setView(view);
 
       glBindFramebuffer(GL_FRAMEBUFFER, debgFramebuffer.id());
       glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
@@ -747,9 +800,13 @@ int main()
     }
 
     glfwSwapBuffers(window);
-    logError("any");
   }
 
+  ModelBuffers::shared.release();
+  frameUniforms.release();
+  jointPalette.release();
+  depthPyramid.release();
+  depthResolve.release();
   glfwTerminate();
   return 0;
 }
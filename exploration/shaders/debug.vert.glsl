@@ -1,12 +1,12 @@
-#version 330 core
+#version 420 core
 
 layout (location = 0) in vec3 aPos;
 
 out vec2 TexCoords;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+#include "frame.glsl"
 
 void main()
 {
@@ -6,19 +6,12 @@ in vec3  norml_geom_out;
 in float order_geom_out;
 in vec4  world_geom_out;
 in vec3  world_normal_geom_out;
+in float prcnt_geom_out;
 
 uniform float frame;
-uniform float ratio;
-uniform float draw_percentage;
-uniform float viewport_width;
-uniform float viewport_height;
 
-uniform vec3 base_camera_direction;
+#include "frame.glsl"
 
-uniform mat4 view;
-uniform mat4 projection;
-uniform mat4 reference_view;
-uniform mat4 reference_projection;
 uniform int code;
 
 const float PI = 3.14159265358979;
@@ -292,7 +285,7 @@ mat4 calculateAngle(float value)
 void main()
 {
   // Throw away the fragment if less than the draw percentage
-  if ((1.0f - order_geom_out) > draw_percentage)
+  if ((1.0f - order_geom_out) > prcnt_geom_out)
 	discard;
 
   // TODO: manual aliasing
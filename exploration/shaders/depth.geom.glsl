@@ -3,12 +3,14 @@
 layout(triangles) in;
 in float order_vert_out[3];
 in vec4  world_vert_out[3];
+in float prcnt_vert_out[3];
 
 layout(triangle_strip, max_vertices = 3) out;
 out vec3  norml_geom_out;
 out float order_geom_out;
 out vec4  world_geom_out;
 out vec3  world_normal_geom_out;
+out float prcnt_geom_out;
 
 vec3 calculateNormal(vec3 p1, vec3 p2, vec3 p3)
 {
@@ -25,6 +27,7 @@ void main()
 	order_geom_out = order_vert_out[0];
 	world_geom_out = world_vert_out[0];
 	world_normal_geom_out = world_normal;
+	prcnt_geom_out = prcnt_vert_out[0];
 	EmitVertex();
 
 	gl_Position = gl_in[1].gl_Position;
@@ -32,6 +35,7 @@ void main()
 	order_geom_out = order_vert_out[1];
 	world_geom_out = world_vert_out[1];
 	world_normal_geom_out = world_normal;
+	prcnt_geom_out = prcnt_vert_out[1];
 	EmitVertex();
 
 	gl_Position = gl_in[2].gl_Position;
@@ -39,5 +43,6 @@ void main()
 	order_geom_out = order_vert_out[2];
 	world_geom_out = world_vert_out[2];
 	world_normal_geom_out = world_normal;
+	prcnt_geom_out = prcnt_vert_out[2];
 	EmitVertex();
 }
@@ -0,0 +1,15 @@
+// the per-frame values every program reads, filled by FrameUniformBuffer; the
+// layout has to match FrameUniforms in graphics/frameUniforms.h
+layout (std140, binding = 0) uniform Frame
+{
+  mat4  projection;
+  mat4  view;
+  mat4  reference_projection;
+  mat4  reference_view;
+  vec3  view_reference;
+  float ratio;
+  vec3  camera_position;
+  float viewport_width;
+  vec3  base_camera_direction;
+  float viewport_height;
+};
@@ -3,17 +3,15 @@
 layout(lines) in;
 in vec4 tess_vertex_offset[2];
 in float order_tess_out[2];
+in float prcnt_tess_out[2];
 
 layout(triangle_strip, max_vertices = 8) out;
 
-uniform sampler2DMS depth_texture;
+uniform sampler2D depth_texture; // resolved to the furthest nearby sample, see resolve.comp.glsl
 
-uniform mat4 view;
-uniform mat4 projection;
+#include "frame.glsl"
 
 uniform float frame;
-uniform float ratio;
-uniform float draw_percentage;
 
 uniform vec3  burst_locations[8];
 uniform float burst_ranges[8];
@@ -68,20 +66,6 @@ float rand()
   return value;
 }
 
-vec4 textureMultisample(sampler2DMS sampler, vec2 uv)
-{
-	ivec2 ssize = textureSize(sampler);
-	ivec2 coord = ivec2(uv * ssize);
-	float line_texture_samples = 8; // TODO: pull this in
-
-    vec4 color = vec4(0.0);
-    for (int i = 0; i < line_texture_samples; i++)
-        color += texelFetch(sampler, coord, i);
-    color /= float(line_texture_samples);
-
-    return color;
-}
-
 mat4 rotate(float theta)
 {
 	return mat4(
@@ -92,38 +76,23 @@ mat4 rotate(float theta)
 	);
 }
 
-float get_depth_1(vec2 v)
+float get_depth(vec2 v)
 {
-	// Convert projection space (-1.0 to 1.0) to texture space (0.0 to 1.0)
+	// Convert projection space (-1.0 to 1.0) to texture space (0.0 to 1.0).
+	// The deepest point from nearby texture points is already taken by the
+	// resolve, so this is a single fetch
 
-	float x = v.x / 2.0f + 0.5f;
-	float y = v.y / 2.0f + 0.5f;
+	ivec2 size = textureSize(depth_texture, 0);
+	ivec2 coord = clamp(ivec2((v / 2.0f + 0.5f) * size), ivec2(0), size - 1);
+
+	float value = texelFetch(depth_texture, coord, 0).x;
 
-	float value = textureMultisample(depth_texture, vec2(x, y)).x;
-	
 	// For some reason, the depth texture has values between 0.5 and 1.0. This
 	// normalizes it to be between 0.0 and 1.0
 
 	return value * 2.0f - 1.0f;
 }
 
-float get_depth(vec2 v)
-{
-	// Because of reasons, I get the deepest point from nearby texture points
-
-	ivec2 size = textureSize(depth_texture);
-
-	vec2 dx = vec2(1.0f / size.x, 0.0f);
-	vec2 dy = vec2(0.0f, 1.0f / size.y);
-
-	float d1 = get_depth_1(v + dx);
-	float d2 = get_depth_1(v - dx);
-	float d3 = get_depth_1(v + dy);
-	float d4 = get_depth_1(v - dy);
-
-	return max(max(d1, d2), max(d3, d4));
-}
-
 bool is_hidden(vec4 p)
 {
 	return p.z / p.w > get_depth(p.xy / p.w) + 0.000001;
@@ -131,12 +100,12 @@ bool is_hidden(vec4 p)
 
 bool is_hidden_start()
 {
-	return (1.0f - order_tess_out[0]) >= draw_percentage || is_hidden(gl_in[0].gl_Position);
+	return (1.0f - order_tess_out[0]) >= prcnt_tess_out[0] || is_hidden(gl_in[0].gl_Position);
 }
 
 bool is_hidden_end()
 {
-	return (1.0f - order_tess_out[1]) >= draw_percentage || is_hidden(gl_in[1].gl_Position);
+	return (1.0f - order_tess_out[1]) >= prcnt_tess_out[0] || is_hidden(gl_in[1].gl_Position);
 }
 
 void _draw_segment(vec4 p, vec4 perp, float thickness)
@@ -184,7 +153,7 @@ vec4 _find_intermediate(vec4 p_hidden, vec4 p_shown, float t_hidden, float t_sho
 		vec4 p_middle = mix(p_hidden, p_shown, 0.5);
 		float t_middle = mix(t_hidden, t_shown, 0.5);
 		float o_middle = mix(order_tess_out[0], order_tess_out[1], t_middle);
-		if ((1.0f - o_middle) > draw_percentage || is_hidden(p_middle))
+		if ((1.0f - o_middle) > prcnt_tess_out[0] || is_hidden(p_middle))
 		{
 			t_hidden = t_middle;
 			p_hidden = p_middle;
@@ -3,14 +3,16 @@
 in float order_vert_out[];
 in float randm_vert_out[];
 in vec4  world_vert_out[];
+in float prcnt_vert_out[];
  
 layout(vertices = 4) out;
 out float order_tesc_out[];
 out float randm_tesc_out[];
+out float prcnt_tesc_out[];
 
 uniform float frame;
-uniform float ratio;
-uniform vec3 camera_position;
+
+#include "frame.glsl"
 
 const float POINT_SPACING = 2.0f / 64.0f;
 
@@ -83,6 +85,7 @@ void main()
 	gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
 	order_tesc_out[gl_InvocationID] = order_vert_out[gl_InvocationID];
 	randm_tesc_out[gl_InvocationID] = randm_vert_out[gl_InvocationID];
+	prcnt_tesc_out[gl_InvocationID] = prcnt_vert_out[gl_InvocationID];
 
 	if (gl_InvocationID == 0)
 	{
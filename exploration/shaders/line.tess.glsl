@@ -3,9 +3,11 @@
 layout(isolines) in;
 in float order_tesc_out[];
 in float randm_tesc_out[];
+in float prcnt_tesc_out[];
 
 out vec4 tess_vertex_offset;
 out float order_tess_out;
+out float prcnt_tess_out;
 
 uniform float frame;
 
@@ -29,6 +31,7 @@ void main()
 
 	gl_Position = mix(gl_in[1].gl_Position, gl_in[2].gl_Position, t);
 	order_tess_out = mix(order_tesc_out[1], order_tesc_out[2], t);
+	prcnt_tess_out = prcnt_tesc_out[1];
 	tess_vertex_offset = vec4(
 		(point_variation(t+v+0) + v) / 2,
 		(point_variation(t+v+1) + v) / 2,
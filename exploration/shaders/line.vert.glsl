@@ -1,24 +1,33 @@
-#version 420 core
+#version 430 core
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aGroups;
 layout (location = 2) in vec3 aWeights;
 layout (location = 3) in float order;
+layout (location = 4) in mat4  instance_model;
+layout (location = 8) in float instance_draw_percentage;
 
 out float order_vert_out;
 out float randm_vert_out;
 out vec4  world_vert_out;
+out float prcnt_vert_out;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
-uniform vec3 view_reference;
+#include "frame.glsl"
+
+#ifndef UNSKINNED
+// every animated entity's joints for this frame, written once by JointPalette
+layout (std430, binding = 1) readonly buffer Joints
+{
+  mat4 joints[];
+};
+uniform int palette_offset; // where this entity's joints start
+#endif
 
-uniform float ratio;
 uniform float frame;
 uniform float draw_percentage;
-uniform mat4 positions[24];
+uniform bool instanced; // model and draw_percentage come from the instance attributes
 
 float seed1 = frame;
 float seed2 = gl_VertexID; // this is a bad seed value, its not unique between instances
@@ -78,14 +87,22 @@ vec3 apply_variation(vec3 point)
 
 void main()
 {
-	vec4 pos0 = model * positions[int(aGroups[0])] * vec4(aPos, 1.0f);
-	vec4 pos1 = model * positions[int(aGroups[1])] * vec4(aPos, 1.0f);
-	vec4 pos2 = model * positions[int(aGroups[2])] * vec4(aPos, 1.0f);
+	mat4 entity_model = instanced ? instance_model : model;
+
+#ifdef UNSKINNED
+	// every joint is where it started, so the blend is just the weights
+	vec4 pos = (aWeights[0] + aWeights[1] + aWeights[2]) * (entity_model * vec4(aPos, 1.0f));
+#else
+	vec4 pos0 = entity_model * joints[palette_offset + int(aGroups[0])] * vec4(aPos, 1.0f);
+	vec4 pos1 = entity_model * joints[palette_offset + int(aGroups[1])] * vec4(aPos, 1.0f);
+	vec4 pos2 = entity_model * joints[palette_offset + int(aGroups[2])] * vec4(aPos, 1.0f);
 	vec4 pos = (aWeights[0] * pos0) + (aWeights[1] * pos1) + (aWeights[2] * pos2);
+#endif
 	
 	// pos.xyz = apply_variation(pos.xyz); // TODO: this doesn't work
 	gl_Position = projection * view * pos;
 	order_vert_out = order;
 	randm_vert_out = rand();
+	prcnt_vert_out = instanced ? instance_draw_percentage : draw_percentage;
 	world_vert_out = pos;
 }
@@ -0,0 +1,34 @@
+#version 450 core
+
+// Builds one level of the depth pyramid: each texel is the furthest depth of
+// the texels it covers in the level above, or in the resolved depth for the
+// first level.
+
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (r32f, binding = 0) uniform writeonly image2D destination;
+layout (r32f, binding = 1) uniform readonly image2D source;
+
+void main()
+{
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	ivec2 size = imageSize(destination);
+	if (any(greaterThanEqual(texel, size)))
+		return;
+
+	// the last row and column also take in the extra texel of an odd sized
+	// source, so nothing is left out
+	ivec2 sourceSize = imageSize(source);
+	ivec2 first = texel * 2;
+	ivec2 last = first + 1 + ivec2(equal(texel, size - 1)) * (sourceSize & 1);
+	last = min(last, sourceSize - 1);
+
+	float depth = 0.0f;
+	for (int y = first.y; y <= last.y; ++y)
+	{
+		for (int x = first.x; x <= last.x; ++x)
+			depth = max(depth, imageLoad(source, ivec2(x, y)).r);
+	}
+
+	imageStore(destination, texel, vec4(depth));
+}
@@ -0,0 +1,44 @@
+#version 450 core
+
+// Resolves the multisampled depth buffer to one value per pixel: the furthest
+// of its samples and of its neighbours' samples out to the dilation, so the
+// line pass can test against it with a single fetch and still never hide a
+// line that any of those samples would show.
+
+layout (local_size_x = 8, local_size_y = 8) in;
+
+layout (r32f, binding = 0) uniform writeonly image2D destination;
+
+uniform sampler2DMS depth_texture;
+uniform int dilation;
+
+float furthest(ivec2 texel, ivec2 size)
+{
+	texel = clamp(texel, ivec2(0), size - 1);
+
+	float depth = 0.0f;
+	for (int i = 0; i < textureSamples(depth_texture); ++i)
+		depth = max(depth, texelFetch(depth_texture, texel, i).r);
+
+	return depth;
+}
+
+void main()
+{
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	ivec2 size = textureSize(depth_texture);
+	if (any(greaterThanEqual(texel, size)))
+		return;
+
+	// neighbours along each axis, the same shape the line pass used to fetch
+	float depth = furthest(texel, size);
+	for (int d = 1; d <= dilation; ++d)
+	{
+		depth = max(depth, furthest(texel + ivec2(d, 0), size));
+		depth = max(depth, furthest(texel - ivec2(d, 0), size));
+		depth = max(depth, furthest(texel + ivec2(0, d), size));
+		depth = max(depth, furthest(texel - ivec2(0, d), size));
+	}
+
+	imageStore(destination, texel, vec4(depth));
+}
@@ -0,0 +1,52 @@
+#ifndef WILT_ARRAYVIEW_H
+#define WILT_ARRAYVIEW_H
+
+#include <cstddef>
+#include <vector>
+
+// A non-owning view of a contiguous array, used to hand out model data without
+// caring whether it lives in a std::vector or in a memory-mapped file.
+template <class T>
+class ArrayView
+{
+private:
+  T* _data;
+  std::size_t _size;
+
+public:
+  ArrayView()
+    : _data{ nullptr }
+    , _size{ 0 }
+  { }
+
+  ArrayView(T* data, std::size_t size)
+    : _data{ data }
+    , _size{ size }
+  { }
+
+  template <class U, class A>
+  ArrayView(const std::vector<U, A>& vector)
+    : _data{ vector.data() }
+    , _size{ vector.size() }
+  { }
+
+  template <class U, class A>
+  ArrayView(std::vector<U, A>& vector)
+    : _data{ vector.data() }
+    , _size{ vector.size() }
+  { }
+
+public:
+  T* data() const { return _data; }
+  std::size_t size() const { return _size; }
+  std::size_t bytes() const { return _size * sizeof(T); }
+  bool empty() const { return _size == 0; }
+
+  T* begin() const { return _data; }
+  T* end() const { return _data + _size; }
+
+  T& operator[] (std::size_t i) const { return _data[i]; }
+
+}; // class ArrayView
+
+#endif // !WILT_ARRAYVIEW_H
@@ -0,0 +1,45 @@
+#include "bounds.h"
+
+glm::vec3 Bounds::center() const
+{
+  return (min + max) * 0.5f;
+}
+
+glm::vec3 Bounds::extents() const
+{
+  return (max - min) * 0.5f;
+}
+
+Bounds Bounds::transformed(const glm::mat4& transform) const
+{
+  // the center moves with the transform and the extents are spread over the
+  // axes by the absolute values of the rotation and scale
+  auto c = glm::vec3(transform * glm::vec4(center(), 1.0f));
+  auto e = extents();
+  auto x = glm::abs(glm::vec3(transform[0])) * e.x;
+  auto y = glm::abs(glm::vec3(transform[1])) * e.y;
+  auto z = glm::abs(glm::vec3(transform[2])) * e.z;
+  auto newExtents = x + y + z;
+
+  return Bounds{ c - newExtents, c + newExtents };
+}
+
+Bounds Bounds::merged(const Bounds& other) const
+{
+  return Bounds{ glm::min(min, other.min), glm::max(max, other.max) };
+}
+
+Bounds Bounds::grown(const glm::vec3& amount) const
+{
+  return Bounds{ min - amount, max + amount };
+}
+
+bool Bounds::contains(const Bounds& other) const
+{
+  return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::greaterThanEqual(max, other.max));
+}
+
+bool Bounds::intersects(const Bounds& other) const
+{
+  return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::greaterThanEqual(max, other.min));
+}
@@ -0,0 +1,24 @@
+#ifndef WILT_BOUNDS_H
+#define WILT_BOUNDS_H
+
+#include <glm/glm.hpp>
+
+// An axis-aligned box.
+struct Bounds
+{
+  glm::vec3 min;
+  glm::vec3 max;
+
+  glm::vec3 center() const;
+  glm::vec3 extents() const; // half the size
+
+  // the box that contains this one after the transform
+  Bounds transformed(const glm::mat4& transform) const;
+  Bounds merged(const Bounds& other) const;
+  Bounds grown(const glm::vec3& amount) const;
+
+  bool contains(const Bounds& other) const;
+  bool intersects(const Bounds& other) const;
+};
+
+#endif // !WILT_BOUNDS_H
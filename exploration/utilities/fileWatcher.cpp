@@ -0,0 +1,129 @@
+#include "fileWatcher.h"
+
+#include <chrono>
+#include <map>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "../logging/LoggingManager.h"
+namespace { auto logger = wilt::logging.createLogger("utilities-filewatcher"); }
+
+FileWatcher::FileWatcher(std::vector<std::filesystem::path> directories, Callback callback)
+  : _directories{ std::move(directories) }
+  , _callback{ std::move(callback) }
+  , _stopping{ false }
+  , _thread{ }
+{
+  _thread = std::thread(&FileWatcher::watch, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+  _stopping = true;
+  _thread.join();
+}
+
+void FileWatcher::watch()
+{
+  if (!watchNotify())
+    watchPoll();
+}
+
+#ifdef __linux__
+bool FileWatcher::watchNotify()
+{
+  int fd = inotify_init1(IN_CLOEXEC);
+  if (fd == -1)
+  {
+    logger.error("initializing inotify, falling back to polling");
+    return false;
+  }
+
+  // editors either rewrite a file in place or write a new one and move it
+  // over the old, so both are treated as a change
+  std::map<int, std::filesystem::path> directories;
+  for (auto& directory : _directories)
+  {
+    int wd = inotify_add_watch(fd, directory.string().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd == -1)
+      logger.error("watching directory: " + directory.string());
+    else
+      directories[wd] = directory;
+  }
+
+  alignas(inotify_event) char buffer[4096];
+  while (!_stopping)
+  {
+    // wake up periodically to notice _stopping
+    pollfd request{ fd, POLLIN, 0 };
+    if (poll(&request, 1, 250) <= 0)
+      continue;
+
+    auto length = read(fd, buffer, sizeof(buffer));
+    if (length <= 0)
+      continue;
+
+    for (auto position = buffer; position < buffer + length; )
+    {
+      auto event = (const inotify_event*)position;
+      position += sizeof(inotify_event) + event->len;
+
+      auto directory = directories.find(event->wd);
+      if (directory == directories.end() || event->len == 0 || (event->mask & IN_ISDIR))
+        continue;
+
+      _callback(directory->second / event->name);
+    }
+  }
+
+  close(fd);
+  return true;
+}
+#else
+bool FileWatcher::watchNotify()
+{
+  return false;
+}
+#endif
+
+void FileWatcher::watchPoll()
+{
+  using namespace std::chrono_literals;
+
+  auto scan = [this]
+  {
+    std::map<std::filesystem::path, std::filesystem::file_time_type> times;
+    for (auto& directory : _directories)
+    {
+      auto error = std::error_code();
+      for (auto& entry : std::filesystem::directory_iterator(directory, error))
+      {
+        if (entry.is_regular_file(error))
+          times[entry.path()] = entry.last_write_time(error);
+      }
+    }
+    return times;
+  };
+
+  // only scan about once a second, but stay responsive to _stopping
+  auto previous = scan();
+  for (int tick = 1; !_stopping; ++tick)
+  {
+    std::this_thread::sleep_for(250ms);
+    if (tick % 4 != 0)
+      continue;
+
+    auto current = scan();
+    for (auto& [path, time] : current)
+    {
+      auto old = previous.find(path);
+      if (old == previous.end() || old->second != time)
+        _callback(path);
+    }
+    previous = std::move(current);
+  }
+}
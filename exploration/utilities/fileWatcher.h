@@ -0,0 +1,44 @@
+#ifndef WILT_FILEWATCHER_H
+#define WILT_FILEWATCHER_H
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Watches a set of directories on a background thread and calls back with the
+// path of any file in them that is written or replaced. Uses inotify where it
+// is available and otherwise checks modification times once a second.
+//
+// The callback runs on the watcher thread.
+class FileWatcher
+{
+public:
+  using Callback = std::function<void(const std::filesystem::path&)>;
+
+private:
+  std::vector<std::filesystem::path> _directories;
+  Callback _callback;
+  std::atomic<bool> _stopping;
+  std::thread _thread;
+
+public:
+  FileWatcher(std::vector<std::filesystem::path> directories, Callback callback);
+  FileWatcher(const FileWatcher& s) = delete;
+  FileWatcher(FileWatcher&& s) = delete;
+
+  FileWatcher& operator= (const FileWatcher& s) = delete;
+  FileWatcher& operator= (FileWatcher&& s) = delete;
+
+  ~FileWatcher();
+
+private:
+  void watch();
+  bool watchNotify();
+  void watchPoll();
+
+}; // class FileWatcher
+
+#endif // !WILT_FILEWATCHER_H
@@ -0,0 +1,167 @@
+#include "mappedFile.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../logging/LoggingManager.h"
+namespace { auto logger = wilt::logging.createLogger("utilities-mappedfile"); }
+
+MappedFile::MappedFile()
+  : _data{ nullptr }
+  , _size{ 0 }
+#ifdef _WIN32
+  , _file{ nullptr }
+  , _mapping{ nullptr }
+#endif
+{ }
+
+MappedFile::MappedFile(MappedFile&& s)
+  : _data{ s._data }
+  , _size{ s._size }
+#ifdef _WIN32
+  , _file{ s._file }
+  , _mapping{ s._mapping }
+#endif
+{
+  s._data = nullptr;
+  s._size = 0;
+#ifdef _WIN32
+  s._file = nullptr;
+  s._mapping = nullptr;
+#endif
+}
+
+MappedFile& MappedFile::operator= (MappedFile&& s)
+{
+  release();
+
+  _data = s._data;
+  _size = s._size;
+  s._data = nullptr;
+  s._size = 0;
+#ifdef _WIN32
+  _file = s._file;
+  _mapping = s._mapping;
+  s._file = nullptr;
+  s._mapping = nullptr;
+#endif
+
+  return *this;
+}
+
+MappedFile::~MappedFile()
+{
+  release();
+}
+
+const char* MappedFile::data() const
+{
+  return _data;
+}
+
+std::size_t MappedFile::size() const
+{
+  return _size;
+}
+
+void MappedFile::release()
+{
+#ifdef _WIN32
+  if (_data != nullptr)
+    UnmapViewOfFile(_data);
+  if (_mapping != nullptr)
+    CloseHandle(_mapping);
+  if (_file != nullptr)
+    CloseHandle(_file);
+  _file = nullptr;
+  _mapping = nullptr;
+#else
+  if (_data != nullptr)
+    munmap((void*)_data, _size);
+#endif
+
+  _data = nullptr;
+  _size = 0;
+}
+
+bool MappedFile::loaded() const
+{
+  return _data != nullptr;
+}
+
+MappedFile MappedFile::fromFile(const std::string& filename)
+{
+  MappedFile file;
+
+#ifdef _WIN32
+  HANDLE handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (handle == INVALID_HANDLE_VALUE)
+  {
+    logger.error("opening file: " + filename);
+    return file;
+  }
+  file._file = handle;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0)
+  {
+    logger.error("empty file: " + filename);
+    file.release();
+    return file;
+  }
+
+  file._mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (file._mapping == nullptr)
+  {
+    logger.error("mapping file: " + filename);
+    file.release();
+    return file;
+  }
+
+  file._data = (const char*)MapViewOfFile(file._mapping, FILE_MAP_READ, 0, 0, 0);
+  file._size = (std::size_t)size.QuadPart;
+  if (file._data == nullptr)
+  {
+    logger.error("mapping file: " + filename);
+    file.release();
+  }
+#else
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1)
+  {
+    logger.error("opening file: " + filename);
+    return file;
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) == -1 || info.st_size == 0)
+  {
+    logger.error("empty file: " + filename);
+    close(fd);
+    return file;
+  }
+
+  // the mapping holds its own reference to the file, so the descriptor can be
+  // closed right away
+  void* data = mmap(nullptr, (std::size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+  {
+    logger.error("mapping file: " + filename);
+    return file;
+  }
+
+  file._data = (const char*)data;
+  file._size = (std::size_t)info.st_size;
+#endif
+
+  return file;
+}
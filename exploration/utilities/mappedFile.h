@@ -0,0 +1,42 @@
+#ifndef WILT_MAPPEDFILE_H
+#define WILT_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// A read-only memory mapping of an entire file. The mapping stays valid until
+// the object is released or destroyed.
+class MappedFile
+{
+private:
+  const char* _data;
+  std::size_t _size;
+
+#ifdef _WIN32
+  void* _file;
+  void* _mapping;
+#endif
+
+public:
+  MappedFile();
+  MappedFile(const MappedFile& s) = delete;
+  MappedFile(MappedFile&& s);
+
+  MappedFile& operator= (const MappedFile& s) = delete;
+  MappedFile& operator= (MappedFile&& s);
+
+  ~MappedFile();
+
+public:
+  const char* data() const;
+  std::size_t size() const;
+
+  void release();
+  bool loaded() const;
+
+public:
+  static MappedFile fromFile(const std::string& filename);
+
+}; // class MappedFile
+
+#endif // !WILT_MAPPEDFILE_H
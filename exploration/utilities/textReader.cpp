@@ -0,0 +1,276 @@
+#include "textReader.h"
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace
+{
+  bool isWhitespace(char c)
+  {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+  }
+
+  bool isDigit(char c)
+  {
+    return c >= '0' && c <= '9';
+  }
+
+  // Handles integers short enough that they can't overflow, leaving the rest
+  // for std::from_chars.
+  template <class T>
+  const char* parseIntegerFast(const char* first, const char* last, T& value)
+  {
+    auto position = first;
+    auto negative = std::is_signed<T>::value && position != last && *position == '-';
+    if (negative)
+      ++position;
+
+    T result = 0;
+    auto start = position;
+    for (; position != last && isDigit(*position); ++position)
+      result = result * 10 + (T)(*position - '0');
+
+    if (position == start || position - start > 9)
+      return nullptr;
+
+    value = negative ? (T)(0 - result) : result;
+    return position;
+  }
+
+  // Attempts the common case of a float with at most 19 significant digits and
+  // a small decimal exponent. The digits are scaled in double precision, which
+  // is within a couple of double ulps of the exact value, and then rounded to
+  // float. That only differs from correctly rounding the exact value when it
+  // lands right next to a point halfway between two floats, so those cases
+  // (and anything else unusual) are left for std::from_chars.
+  const char* parseFloatFast(const char* first, const char* last, float& value)
+  {
+    static const double powers[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    auto position = first;
+    auto negative = position != last && *position == '-';
+    if (negative)
+      ++position;
+
+    std::uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+
+    auto start = position;
+    for (; position != last && isDigit(*position); ++position)
+      mantissa = mantissa * 10 + (*position - '0');
+    auto wholeDigits = position - start;
+    digits += (int)wholeDigits;
+
+    if (position != last && *position == '.')
+    {
+      ++position;
+      start = position;
+      for (; position != last && isDigit(*position); ++position)
+        mantissa = mantissa * 10 + (*position - '0');
+      digits += (int)(position - start);
+      exponent -= (int)(position - start);
+      if (wholeDigits == 0 && position == start)
+        return nullptr;
+    }
+    else if (wholeDigits == 0)
+      return nullptr;
+
+    if (position != last && (*position == 'e' || *position == 'E'))
+    {
+      auto exponentStart = position + 1;
+      auto exponentNegative = exponentStart != last && *exponentStart == '-';
+      if (exponentStart != last && (*exponentStart == '-' || *exponentStart == '+'))
+        ++exponentStart;
+
+      if (exponentStart != last && isDigit(*exponentStart))
+      {
+        int explicitExponent = 0;
+        for (position = exponentStart; position != last && isDigit(*position); ++position)
+          if (explicitExponent < 1000)
+            explicitExponent = explicitExponent * 10 + (*position - '0');
+        exponent += exponentNegative ? -explicitExponent : explicitExponent;
+      }
+    }
+
+    // leading zeros don't count towards the precision of the mantissa
+    if (digits > 19)
+    {
+      for (auto c = first; c != position && (*c == '-' || *c == '0' || *c == '.'); ++c)
+        if (*c == '0')
+          --digits;
+      if (digits > 19)
+        return nullptr;
+    }
+
+    if (exponent < -22 || exponent > 22)
+      return nullptr;
+
+    auto result = (double)mantissa;
+    result = exponent < 0 ? result / powers[-exponent] : result * powers[exponent];
+
+    if (result != 0.0)
+    {
+      if (result < 1.17549435e-38 || result > 3.40282347e+38)
+        return nullptr;
+
+      std::uint64_t bits;
+      std::memcpy(&bits, &result, sizeof(bits));
+
+      // distance, in double ulps, from the nearest float rounding midpoint
+      auto low = (std::int64_t)(bits & ((1ull << 29) - 1)) - (1ll << 28);
+      if (low > -8 && low < 8)
+        return nullptr;
+    }
+
+    value = (float)(negative ? -result : result);
+    return position;
+  }
+}
+
+TextReader::TextReader()
+  : _file{ }
+  , _position{ nullptr }
+  , _end{ nullptr }
+  , _failed{ true }
+{ }
+
+TextReader::TextReader(MappedFile file)
+  : _file{ std::move(file) }
+  , _position{ _file.data() }
+  , _end{ _file.data() + _file.size() }
+  , _failed{ !_file.loaded() }
+{ }
+
+TextReader::TextReader(TextReader&& s)
+  : TextReader{}
+{
+  *this = std::move(s);
+}
+
+TextReader& TextReader::operator= (TextReader&& s)
+{
+  _file = std::move(s._file);
+  _position = s._position;
+  _end = s._end;
+  _failed = s._failed;
+
+  s._position = nullptr;
+  s._end = nullptr;
+  s._failed = true;
+
+  return *this;
+}
+
+TextReader::operator bool() const
+{
+  return !_failed;
+}
+
+bool TextReader::fail() const
+{
+  return _failed;
+}
+
+bool TextReader::eof() const
+{
+  return _position == _end;
+}
+
+bool TextReader::skipWhitespace()
+{
+  if (_failed)
+    return false;
+
+  while (_position != _end && isWhitespace(*_position))
+    ++_position;
+
+  if (_position == _end)
+    _failed = true;
+
+  return !_failed;
+}
+
+TextReader& TextReader::operator>> (float& value)
+{
+  if (!skipWhitespace())
+    return *this;
+
+  if (auto position = parseFloatFast(_position, _end, value))
+  {
+    _position = position;
+    return *this;
+  }
+
+  auto result = std::from_chars(_position, _end, value);
+  if (result.ec != std::errc())
+    _failed = true;
+  else
+    _position = result.ptr;
+
+  return *this;
+}
+
+TextReader& TextReader::operator>> (int& value)
+{
+  if (!skipWhitespace())
+    return *this;
+
+  if (auto position = parseIntegerFast(_position, _end, value))
+  {
+    _position = position;
+    return *this;
+  }
+
+  auto result = std::from_chars(_position, _end, value);
+  if (result.ec != std::errc())
+    _failed = true;
+  else
+    _position = result.ptr;
+
+  return *this;
+}
+
+TextReader& TextReader::operator>> (unsigned int& value)
+{
+  if (!skipWhitespace())
+    return *this;
+
+  if (auto position = parseIntegerFast(_position, _end, value))
+  {
+    _position = position;
+    return *this;
+  }
+
+  auto result = std::from_chars(_position, _end, value);
+  if (result.ec != std::errc())
+    _failed = true;
+  else
+    _position = result.ptr;
+
+  return *this;
+}
+
+TextReader& TextReader::operator>> (std::string& value)
+{
+  if (!skipWhitespace())
+    return *this;
+
+  auto start = _position;
+  while (_position != _end && !isWhitespace(*_position))
+    ++_position;
+
+  value.assign(start, _position);
+
+  return *this;
+}
+
+TextReader TextReader::fromFile(const std::string& filename)
+{
+  return TextReader{ MappedFile::fromFile(filename) };
+}
@@ -0,0 +1,51 @@
+#ifndef WILT_TEXTREADER_H
+#define WILT_TEXTREADER_H
+
+#include <string>
+
+#include "mappedFile.h"
+
+// Reads whitespace-separated values out of a memory mapped file. It stands in
+// for std::ifstream's operator>> in the model, level and animation readers,
+// but parses straight out of the mapping (falling back to std::from_chars for
+// awkward floats) so there is no copy, locale or stream state involved.
+//
+// Like a stream, a failed read sets the fail state and every read after that
+// is a no-op.
+class TextReader
+{
+private:
+  MappedFile _file;
+  const char* _position;
+  const char* _end;
+  bool _failed;
+
+public:
+  TextReader();
+  explicit TextReader(MappedFile file);
+  TextReader(const TextReader& s) = delete;
+  TextReader(TextReader&& s);
+
+  TextReader& operator= (const TextReader& s) = delete;
+  TextReader& operator= (TextReader&& s);
+
+public:
+  explicit operator bool() const;
+  bool fail() const;
+  bool eof() const;
+
+public:
+  TextReader& operator>> (float& value);
+  TextReader& operator>> (int& value);
+  TextReader& operator>> (unsigned int& value);
+  TextReader& operator>> (std::string& value);
+
+public:
+  static TextReader fromFile(const std::string& filename);
+
+private:
+  bool skipWhitespace();
+
+}; // class TextReader
+
+#endif // !WILT_TEXTREADER_H
@@ -0,0 +1,90 @@
+#include "workerPool.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool()
+  : WorkerPool{ std::max(std::thread::hardware_concurrency(), 1u) - 1 }
+{ }
+
+WorkerPool::WorkerPool(std::size_t workerCount)
+  : _workers{ }
+  , _tasks{ }
+  , _pending{ 0 }
+  , _stopping{ false }
+{
+  _workers.reserve(workerCount);
+  for (std::size_t i = 0; i < workerCount; ++i)
+    _workers.emplace_back(&WorkerPool::work, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+  wait();
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stopping = true;
+  }
+  _taskAdded.notify_all();
+
+  for (auto& worker : _workers)
+    worker.join();
+}
+
+std::size_t WorkerPool::size() const
+{
+  return _workers.size();
+}
+
+void WorkerPool::submit(std::function<void()> task)
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _tasks.push_back(std::move(task));
+    _pending += 1;
+  }
+  _taskAdded.notify_one();
+}
+
+void WorkerPool::wait()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+
+  // help out rather than sit idle
+  while (runOne(lock))
+    ;
+
+  _taskFinished.wait(lock, [this] { return _pending == 0; });
+}
+
+bool WorkerPool::runOne(std::unique_lock<std::mutex>& lock)
+{
+  if (_tasks.empty())
+    return false;
+
+  auto task = std::move(_tasks.front());
+  _tasks.pop_front();
+
+  lock.unlock();
+  task();
+  lock.lock();
+
+  _pending -= 1;
+  if (_pending == 0)
+    _taskFinished.notify_all();
+
+  return true;
+}
+
+void WorkerPool::work()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true)
+  {
+    _taskAdded.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+    if (_stopping && _tasks.empty())
+      return;
+
+    runOne(lock);
+  }
+}
@@ -0,0 +1,53 @@
+#ifndef WILT_WORKERPOOL_H
+#define WILT_WORKERPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of threads that run submitted tasks in no particular order. The
+// thread calling wait() also runs tasks until the queue is empty, so a pool
+// with no workers still works, it just runs everything in wait().
+//
+// Tasks must not touch the GL context; that belongs to the main thread.
+class WorkerPool
+{
+private:
+  std::vector<std::thread> _workers;
+  std::deque<std::function<void()>> _tasks;
+  std::size_t _pending;
+  bool _stopping;
+
+  std::mutex _mutex;
+  std::condition_variable _taskAdded;
+  std::condition_variable _taskFinished;
+
+public:
+  // defaults to one worker per core, less the calling thread
+  WorkerPool();
+  explicit WorkerPool(std::size_t workerCount);
+  WorkerPool(const WorkerPool& s) = delete;
+  WorkerPool(WorkerPool&& s) = delete;
+
+  WorkerPool& operator= (const WorkerPool& s) = delete;
+  WorkerPool& operator= (WorkerPool&& s) = delete;
+
+  ~WorkerPool();
+
+public:
+  std::size_t size() const;
+
+  void submit(std::function<void()> task);
+  void wait();
+
+private:
+  bool runOne(std::unique_lock<std::mutex>& lock);
+  void work();
+
+}; // class WorkerPool
+
+#endif // !WILT_WORKERPOOL_H
@@ -0,0 +1,213 @@
+// Compares the TextReader-based Model::read against the std::ifstream parser it
+// replaced. The legacy parser is kept here verbatim as the reference: the
+// benchmark fails if the two produce data that isn't bit-identical.
+//
+//   usage: benchmark_model_parse [iterations] [model.txt ...]
+//   (defaults to 20 iterations of models/octane_model.txt)
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "Model.h"
+#include "DecorationModel.h"
+#include "utilities/textReader.h"
+
+namespace
+{
+  struct LegacyModel
+  {
+    std::vector<float> vertexData;
+    std::vector<unsigned int> lineIndexes;
+    std::vector<unsigned int> faceIndexes;
+    std::vector<Joint> joints;
+    glm::vec3 boundingA = glm::vec3(-1, -1, -1);
+    glm::vec3 boundingB = glm::vec3(1, 1, 1);
+  };
+
+  void readLegacy(LegacyModel& model, std::ifstream& file, int version)
+  {
+    if (version == 3)
+    {
+      file >> model.boundingA.x >> model.boundingA.y >> model.boundingA.z;
+      file >> model.boundingB.x >> model.boundingB.y >> model.boundingB.z;
+    }
+
+    int vertexCount;
+    file >> vertexCount;
+    model.vertexData.resize(vertexCount * 10);
+    for (std::size_t i = 0; i < model.vertexData.size(); i += 10)
+    {
+      for (std::size_t j = 0; j < 9; ++j)
+        file >> model.vertexData[i + j];
+      if (version == 1)
+        model.vertexData[i + 9] = 1.0f;
+      else
+        file >> model.vertexData[i + 9];
+    }
+
+    int faceCount;
+    file >> faceCount;
+    model.faceIndexes.resize(faceCount * 3);
+    for (std::size_t i = 0; i < model.faceIndexes.size(); ++i)
+      file >> model.faceIndexes[i];
+
+    int lineCount;
+    file >> lineCount;
+    model.lineIndexes.resize(lineCount * 4);
+    for (std::size_t i = 0; i < model.lineIndexes.size(); ++i)
+      file >> model.lineIndexes[i];
+
+    int jointCount;
+    file >> jointCount;
+    model.joints.resize(jointCount);
+    for (int i = 0; i < jointCount; ++i)
+    {
+      int parentIndex;
+      glm::vec3 location;
+      glm::quat rotation;
+
+      file >> parentIndex;
+      file >> location[0] >> location[1] >> location[2];
+      file >> rotation[3] >> rotation[0] >> rotation[1] >> rotation[2];
+
+      model.joints[i] = Joint(parentIndex, location, rotation);
+    }
+  }
+
+  LegacyModel readLegacy(const std::string& filename)
+  {
+    LegacyModel model;
+    std::ifstream file(filename);
+
+    std::string type;
+    int version;
+    file >> type >> version;
+
+    // decoration versions 3 and 4 prefix model versions 2 and 3 with six
+    // distance parameters
+    if (type == "decoration" && version >= 3)
+    {
+      float parameter;
+      for (int i = 0; i < 6; ++i)
+        file >> parameter;
+      version -= 1;
+    }
+
+    readLegacy(model, file, version);
+    return model;
+  }
+
+  Model readCurrent(const std::string& filename)
+  {
+    auto file = TextReader::fromFile(filename);
+
+    std::string type;
+    file >> type;
+
+    if (type == "decoration")
+    {
+      DecorationModel model;
+      model.read(file);
+      return std::move(model);
+    }
+
+    Model model;
+    model.read(file);
+    return model;
+  }
+
+  template <class T>
+  bool identical(ArrayView<const T> a, const std::vector<T>& b)
+  {
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.bytes()) == 0;
+  }
+
+  bool identical(const Model& current, const LegacyModel& legacy)
+  {
+    if (!identical(current.vertices(), legacy.vertexData) ||
+        !identical(current.faces(), legacy.faceIndexes) ||
+        !identical(current.lines(), legacy.lineIndexes) ||
+        std::memcmp(&current.boundingA, &legacy.boundingA, sizeof(glm::vec3)) != 0 ||
+        std::memcmp(&current.boundingB, &legacy.boundingB, sizeof(glm::vec3)) != 0 ||
+        current.joints.size() != legacy.joints.size())
+      return false;
+
+    for (std::size_t i = 0; i < current.joints.size(); ++i)
+    {
+      if (current.joints[i].parentIndex() != legacy.joints[i].parentIndex() ||
+          std::memcmp(&current.joints[i].transform(), &legacy.joints[i].transform(), sizeof(glm::mat4)) != 0)
+        return false;
+    }
+
+    return true;
+  }
+
+  // best of the runs rather than the mean, which is less sensitive to
+  // whatever else the machine is doing
+  template <class F>
+  double measure(int iterations, F&& function)
+  {
+    auto best = std::numeric_limits<double>::max();
+    for (int i = 0; i < iterations; ++i)
+    {
+      auto start = std::chrono::high_resolution_clock::now();
+      function();
+      auto end = std::chrono::high_resolution_clock::now();
+
+      best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    return best;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  auto iterations = 20;
+  auto filenames = std::vector<std::string>();
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if (i == 1 && std::isdigit((unsigned char)argv[i][0]))
+      iterations = std::stoi(argv[i]);
+    else
+      filenames.push_back(argv[i]);
+  }
+  if (filenames.empty())
+    filenames.push_back("models/octane_model.txt");
+
+  auto failures = 0;
+  for (auto& filename : filenames)
+  {
+    if (!std::ifstream(filename))
+    {
+      std::cout << filename << ": cannot open" << std::endl;
+      failures += 1;
+      continue;
+    }
+
+    auto same = identical(readCurrent(filename), readLegacy(filename));
+    auto legacyTime = measure(iterations, [&] { readLegacy(filename); });
+    auto currentTime = measure(iterations, [&] { readCurrent(filename); });
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << filename << std::endl;
+    std::cout << "  ifstream:   " << legacyTime << " ms" << std::endl;
+    std::cout << "  TextReader: " << currentTime << " ms" << std::endl;
+    std::cout << "  speedup:    " << legacyTime / currentTime << "x" << std::endl;
+    std::cout << "  output:     " << (same ? "bit-identical" : "MISMATCH") << std::endl;
+
+    if (!same)
+      failures += 1;
+  }
+
+  return failures == 0 ? 0 : 1;
+}
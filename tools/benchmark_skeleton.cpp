@@ -0,0 +1,203 @@
+// Compares Skeleton::pose, which walks a baked skeleton once with the inverse
+// bind matrices already known, against the chain LoopAnimator used to run for
+// every entity: walking parent indices, inverting each bind transform and
+// allocating its scratch on every call. Each entity of the crowd samples its
+// own point in a looping animation. The benchmark fails if the two disagree by
+// more than float rounding.
+//
+//   usage: benchmark_skeleton [iterations] [entities ...]
+//   (defaults to 20 iterations of 1000 and 10000 entities)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cctype>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "graphics/joint.h"
+#include "graphics/jointPose.h"
+#include "graphics/skeleton.h"
+
+namespace
+{
+  const int FRAME_COUNT = 48;
+
+  glm::quat randomRotation(std::mt19937& random)
+  {
+    auto component = std::uniform_real_distribution<float>{ -1.0f, 1.0f };
+    return glm::normalize(glm::quat(component(random), component(random), component(random), component(random)));
+  }
+
+  glm::vec3 randomLocation(std::mt19937& random)
+  {
+    auto component = std::uniform_real_distribution<float>{ -0.5f, 0.5f };
+    return glm::vec3(component(random), component(random), component(random));
+  }
+
+  // a branching hierarchy of MAX_JOINTS joints with parents before children,
+  // the order the exporter writes them in
+  std::vector<Joint> makeJoints(std::mt19937& random)
+  {
+    auto joints = std::vector<Joint>();
+    for (int i = 0; i < MAX_JOINTS; ++i)
+    {
+      auto parent = i == 0 ? -1 : std::uniform_int_distribution<int>{ std::max(0, i - 4), i - 1 }(random);
+      joints.push_back(Joint(parent, randomLocation(random), randomRotation(random)));
+    }
+
+    return joints;
+  }
+
+  std::vector<std::vector<JointPose>> makeFrames(std::mt19937& random)
+  {
+    auto frames = std::vector<std::vector<JointPose>>(FRAME_COUNT);
+    for (auto& frame : frames)
+      for (int i = 0; i < MAX_JOINTS; ++i)
+        frame.push_back(JointPose(randomLocation(random), randomRotation(random)));
+
+    return frames;
+  }
+
+  // the old JointPose::calcLocalTransform, two matrices multiplied together
+  glm::mat4 chainLocalTransform(const JointPose& pose)
+  {
+    glm::mat4 locationTransform = glm::translate(glm::mat4(), { pose.location.x, -pose.location.z, pose.location.y });
+    glm::mat4 rotationTransform = (glm::mat4)glm::quat(pose.rotation.w, pose.rotation.x, -pose.rotation.z, pose.rotation.y);
+
+    return locationTransform * rotationTransform;
+  }
+
+  // LoopAnimator::applyAnimation as it was before the skeleton was baked
+  void poseChain(const std::vector<Joint>& joints, const std::vector<JointPose>& poses1, const std::vector<JointPose>& poses2, float interp, glm::mat4* transforms)
+  {
+    std::vector<glm::mat4> animatedTransforms(poses1.size());
+    std::vector<glm::mat4> forwardTransforms(poses1.size());
+    std::vector<glm::mat4> backwardTransforms(poses1.size());
+
+    for (std::size_t i = 0; i < poses1.size(); ++i)
+    {
+      auto p = joints[i].parentIndex();
+      auto forward = (p != -1) ? forwardTransforms[p] : glm::mat4();
+      auto backward = (p != -1) ? backwardTransforms[p] : glm::mat4();
+
+      JointPose interpolatedJointPose = JointPose::interpolate(poses1[i], poses2[i], interp);
+      glm::mat4 interpolatedTransform = chainLocalTransform(interpolatedJointPose);
+      forwardTransforms[i] = forward * joints[i].transform() * interpolatedTransform;
+      backwardTransforms[i] = glm::inverse(joints[i].transform()) * backward;
+      animatedTransforms[i] = forwardTransforms[i] * backwardTransforms[i];
+    }
+
+    std::copy(animatedTransforms.begin(), animatedTransforms.end(), transforms);
+  }
+
+  // every entity samples the animation at its own time
+  template <class F>
+  void poseCrowd(const std::vector<float>& times, const std::vector<std::vector<JointPose>>& frames, std::vector<glm::mat4>& transforms, F&& pose)
+  {
+    for (std::size_t i = 0; i < times.size(); ++i)
+    {
+      float position = std::fmod(times[i] * 24.0f, (float)frames.size());
+      int frame1 = (int)position;
+      int frame2 = (frame1 + 1) % frames.size();
+
+      pose(frames[frame1], frames[frame2], position - frame1, &transforms[i * MAX_JOINTS]);
+    }
+  }
+
+  float difference(const std::vector<glm::mat4>& a, const std::vector<glm::mat4>& b)
+  {
+    auto largest = 0.0f;
+    for (std::size_t i = 0; i < a.size(); ++i)
+      for (int column = 0; column < 4; ++column)
+        for (int row = 0; row < 4; ++row)
+          largest = std::max(largest, std::abs(a[i][column][row] - b[i][column][row]));
+
+    return largest;
+  }
+
+  // best of the runs rather than the mean, which is less sensitive to
+  // whatever else the machine is doing
+  template <class F>
+  double measure(int iterations, F&& function)
+  {
+    auto best = std::numeric_limits<double>::max();
+    for (int i = 0; i < iterations; ++i)
+    {
+      auto start = std::chrono::high_resolution_clock::now();
+      function();
+      auto end = std::chrono::high_resolution_clock::now();
+
+      best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    return best;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  auto iterations = 20;
+  auto counts = std::vector<std::size_t>();
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if (i == 1 && argc > 2 && std::isdigit((unsigned char)argv[i][0]))
+      iterations = std::stoi(argv[i]);
+    else
+      counts.push_back(std::stoul(argv[i]));
+  }
+  if (counts.empty())
+    counts = { 1000, 10000 };
+
+  const auto TOLERANCE = 1e-4f;
+
+  auto random = std::mt19937{ 1234 };
+  auto joints = makeJoints(random);
+  auto frames = makeFrames(random);
+  auto skeleton = Skeleton::bake(joints);
+
+  auto failures = 0;
+  for (auto count : counts)
+  {
+    auto time = std::uniform_real_distribution<float>{ 0.0f, 100.0f };
+    auto times = std::vector<float>(count);
+    for (auto& t : times)
+      t = time(random);
+
+    auto chain = std::vector<glm::mat4>(count * MAX_JOINTS);
+    auto baked = std::vector<glm::mat4>(count * MAX_JOINTS);
+
+    auto chainTime = measure(iterations, [&] {
+      poseCrowd(times, frames, chain, [&](auto& poses1, auto& poses2, float interp, glm::mat4* transforms) {
+        poseChain(joints, poses1, poses2, interp, transforms);
+      });
+    });
+    auto bakedTime = measure(iterations, [&] {
+      poseCrowd(times, frames, baked, [&](auto& poses1, auto& poses2, float interp, glm::mat4* transforms) {
+        skeleton.pose(poses1.data(), poses2.data(), interp, transforms);
+      });
+    });
+    auto error = difference(chain, baked);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << count << " entities, " << MAX_JOINTS << " joints" << std::endl;
+    std::cout << "  parent chain: " << chainTime << " ms, " << count / chainTime << " k poses/s" << std::endl;
+    std::cout << "  baked:        " << bakedTime << " ms, " << count / bakedTime << " k poses/s" << std::endl;
+    std::cout << "  speedup:      " << chainTime / bakedTime << "x" << std::endl;
+    std::cout << "  difference:   " << std::scientific << error << (error <= TOLERANCE ? "" : " MISMATCH") << std::endl;
+
+    if (!(error <= TOLERANCE))
+      failures += 1;
+  }
+
+  return failures == 0 ? 0 : 1;
+}
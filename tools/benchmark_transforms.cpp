@@ -0,0 +1,178 @@
+// Compares EntityTransforms::buildTransforms, which builds entity transforms
+// four at a time from separate position, rotation and scale arrays, against
+// calling the scalar glm chain in EntityTransforms::makeTransform for each
+// entity. The benchmark fails if the two disagree by more than float rounding,
+// or if EntityTransforms doesn't hand out removed slots again.
+//
+//   usage: benchmark_transforms [iterations] [entities ...]
+//   (defaults to 20 iterations of 10000 and 100000 entities)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cctype>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "entities/EntityTransforms.h"
+
+namespace
+{
+  struct Inputs
+  {
+    std::vector<float> positionX, positionY, positionZ;
+    std::vector<float> rotationX, rotationY, rotationZ;
+    std::vector<float> scale;
+
+    TransformInputs view() const
+    {
+      return TransformInputs{
+        positionX.data(), positionY.data(), positionZ.data(),
+        rotationX.data(), rotationY.data(), rotationZ.data(),
+        scale.data()
+      };
+    }
+  };
+
+  // positions across a large world, angles over several turns either way
+  Inputs makeInputs(std::size_t count)
+  {
+    auto random = std::mt19937{ 1234 };
+    auto position = std::uniform_real_distribution<float>{ -500.0f, 500.0f };
+    auto angle = std::uniform_real_distribution<float>{ -20.0f, 20.0f };
+    auto scale = std::uniform_real_distribution<float>{ 0.1f, 4.0f };
+
+    auto inputs = Inputs{};
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      inputs.positionX.push_back(position(random));
+      inputs.positionY.push_back(position(random));
+      inputs.positionZ.push_back(position(random));
+      inputs.rotationX.push_back(angle(random));
+      inputs.rotationY.push_back(angle(random));
+      inputs.rotationZ.push_back(angle(random));
+      inputs.scale.push_back(scale(random));
+    }
+
+    return inputs;
+  }
+
+  void buildScalar(const Inputs& inputs, std::vector<glm::mat4>& transforms)
+  {
+    for (std::size_t i = 0; i < transforms.size(); ++i)
+    {
+      transforms[i] = EntityTransforms::makeTransform(
+        { inputs.positionX[i], inputs.positionY[i], inputs.positionZ[i] },
+        { inputs.rotationX[i], inputs.rotationY[i], inputs.rotationZ[i] },
+        inputs.scale[i]);
+    }
+  }
+
+  // the largest difference relative to the scale, since the rotation part of
+  // each column is scaled and the translation isn't affected by the kernel
+  float difference(const Inputs& inputs, const std::vector<glm::mat4>& a, const std::vector<glm::mat4>& b)
+  {
+    auto largest = 0.0f;
+    for (std::size_t i = 0; i < a.size(); ++i)
+      for (int column = 0; column < 4; ++column)
+        for (int row = 0; row < 4; ++row)
+        {
+          auto magnitude = column < 3 ? inputs.scale[i] : 1.0f;
+          largest = std::max(largest, std::abs(a[i][column][row] - b[i][column][row]) / magnitude);
+        }
+
+    return largest;
+  }
+
+  // removed entities' slots have to be reused, otherwise the arrays (and the
+  // work build() does) grow with every entity ever spawned
+  bool checkSlotReuse()
+  {
+    auto transforms = EntityTransforms{};
+    auto first = transforms.add();
+    auto second = transforms.add();
+    transforms.remove(first);
+
+    auto reused = transforms.add();
+    transforms.update(reused, { 1.0f, 2.0f, 3.0f }, { 0.5f, 0.0f, 0.0f }, 2.0f);
+    transforms.build();
+
+    auto expected = EntityTransforms::makeTransform({ 1.0f, 2.0f, 3.0f }, { 0.5f, 0.0f, 0.0f }, 2.0f);
+    auto rebuilt = true;
+    for (int column = 0; column < 4; ++column)
+      for (int row = 0; row < 4; ++row)
+        rebuilt = rebuilt && std::abs(transforms[reused][column][row] - expected[column][row]) <= 1e-5f;
+
+    return reused == first && reused != second && transforms.transforms().size() == 2 && rebuilt;
+  }
+
+  // best of the runs rather than the mean, which is less sensitive to
+  // whatever else the machine is doing
+  template <class F>
+  double measure(int iterations, F&& function)
+  {
+    auto best = std::numeric_limits<double>::max();
+    for (int i = 0; i < iterations; ++i)
+    {
+      auto start = std::chrono::high_resolution_clock::now();
+      function();
+      auto end = std::chrono::high_resolution_clock::now();
+
+      best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    return best;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  auto iterations = 20;
+  auto counts = std::vector<std::size_t>();
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if (i == 1 && argc > 2 && std::isdigit((unsigned char)argv[i][0]))
+      iterations = std::stoi(argv[i]);
+    else
+      counts.push_back(std::stoul(argv[i]));
+  }
+  if (counts.empty())
+    counts = { 10000, 100000 };
+
+  const auto TOLERANCE = 1e-5f;
+
+  auto failures = 0;
+  if (!checkSlotReuse())
+  {
+    std::cout << "removed slots aren't reused" << std::endl;
+    failures += 1;
+  }
+
+  for (auto count : counts)
+  {
+    auto inputs = makeInputs(count);
+    auto scalar = std::vector<glm::mat4>(count);
+    auto batched = std::vector<glm::mat4>(count);
+
+    auto scalarTime = measure(iterations, [&] { buildScalar(inputs, scalar); });
+    auto batchedTime = measure(iterations, [&] { EntityTransforms::buildTransforms(inputs.view(), count, batched.data()); });
+    auto error = difference(inputs, scalar, batched);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << count << " entities" << std::endl;
+    std::cout << "  glm chain:  " << scalarTime << " ms, " << count / scalarTime / 1000.0 << " M matrices/s" << std::endl;
+    std::cout << "  batched:    " << batchedTime << " ms, " << count / batchedTime / 1000.0 << " M matrices/s" << std::endl;
+    std::cout << "  speedup:    " << scalarTime / batchedTime << "x" << std::endl;
+    std::cout << "  difference: " << std::scientific << error << (error <= TOLERANCE ? "" : " MISMATCH") << std::endl;
+
+    if (!(error <= TOLERANCE))
+      failures += 1;
+  }
+
+  return failures == 0 ? 0 : 1;
+}
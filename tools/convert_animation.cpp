@@ -0,0 +1,101 @@
+// Converts the text animations blender_export_animation.py writes into the
+// binary clips (*_animation.bin) that read_animation prefers when they are up
+// to date. Each output is written next to its input with a .bin extension.
+//
+// The size before and after is reported for each clip, along with how many
+// tracks still need a key every frame and the largest difference between the
+// decoded and the exported keys.
+//
+//   usage: convert_animation animation.txt [more_animation.txt ...]
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "AnimationClip.h"
+#include "logging/LoggingManager.h"
+#include "logging/loggers/StreamLogger.h"
+#include "utilities/textReader.h"
+
+namespace { auto logger = wilt::logging.createLogger("convert_animation"); }
+
+bool convert(const std::string& input)
+{
+  auto file = TextReader::fromFile(input);
+  if (!file)
+  {
+    logger.error("opening file: " + input);
+    return false;
+  }
+
+  auto frames = std::vector<std::vector<JointPose>>();
+  if (!AnimationClip::readFrames(file, frames))
+  {
+    logger.error("parsing file: " + input);
+    return false;
+  }
+
+  auto clip = AnimationClip::encode(frames);
+  if (!clip.loaded())
+    return false;
+
+  // compared against the normalized exported rotation, which is what's encoded
+  auto locationError = 0.0f;
+  auto rotationError = 0.0f;
+  auto poses = std::vector<JointPose>(clip.jointCount());
+  for (std::size_t f = 0; f < clip.frameCount(); ++f)
+  {
+    clip.decode(f, poses.data());
+    for (std::size_t j = 0; j < poses.size(); ++j)
+    {
+      auto rotation = glm::normalize(frames[f][j].rotation);
+      for (int i = 0; i < 3; ++i)
+        locationError = std::max(locationError, std::abs(poses[j].location[i] - frames[f][j].location[i]));
+      for (int i = 0; i < 4; ++i)
+        rotationError = std::max(rotationError, std::abs(poses[j].rotation[i] - rotation[i]));
+    }
+  }
+
+  auto& header = clip.header();
+  auto rawBytes = clip.frameCount() * clip.jointCount() * 7 * sizeof(float);
+
+  std::ostringstream report;
+  report << input << ": " << clip.frameCount() << " frames, " << clip.jointCount() << " joints, "
+    << rawBytes << " bytes as floats -> " << clip.bytes() << " bytes, "
+    << header.sampledLocationCount << " sampled location and "
+    << header.sampledRotationCount << " sampled rotation tracks, "
+    << std::scientific << std::setprecision(2)
+    << "error " << locationError << " location " << rotationError << " rotation";
+  logger.info(report.str());
+
+  auto output = std::filesystem::path(input).replace_extension(".bin").string();
+  return clip.write(output);
+}
+
+int main(int argc, char** argv)
+{
+  wilt::logging.setLogger<wilt::StreamLogger>(std::cout);
+  wilt::logging.setLevel(wilt::LoggingLevel::INFO);
+
+  if (argc < 2)
+  {
+    std::cout << "usage: " << argv[0] << " <animation.txt>..." << std::endl;
+    return 1;
+  }
+
+  auto failures = 0;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (convert(argv[i]))
+      logger.info(std::string("converted ") + argv[i]);
+    else
+      failures += 1;
+  }
+
+  return failures == 0 ? 0 : 1;
+}